@@ -55,6 +55,8 @@ namespace Beelzebub { namespace Execution
 
         inline ProcessArchitecturalBase()
             : PagingTable( nullpaddr)
+            , Pcid(0)
+            , TlbGeneration(0)
         {
 
         }
@@ -70,5 +72,9 @@ namespace Beelzebub { namespace Execution
 
         paddr_t PagingTable;
         void SetPagingTable(paddr_t pt);
+
+        uint16_t Pcid;
+        Synchronization::Atomic<uint64_t> TlbGeneration;
+        //  Tag of this process' TLB entries, and the stamp of their last invalidation.
     };
 }}
@@ -39,6 +39,7 @@
 
 #pragma once
 
+#include <memory/pmm.hpp>
 #include <beel/structs.kernel.h>
 #include <beel/sync/smp.lock.hpp>
 #include <math.h>
@@ -55,6 +56,8 @@ namespace Beelzebub { namespace Memory
         Split    =  2,
         Full     =  3,
         Reserved =  4,
+        Huge     =  5,  //  First large frame of a 1-GiB frame.
+        Spanned  =  6,  //  Any other large frame of a 1-GiB frame.
     };
 
     /**
@@ -101,7 +104,7 @@ namespace Beelzebub { namespace Memory
 
         __forceinline uint32_t AdjustReferenceCount(int32_t diff)
         {
-            return this->ReferenceCount += diff;
+            return __atomic_add_fetch(&(this->ReferenceCount), diff, __ATOMIC_SEQ_CST);
         }
 
         /*  Status  */
@@ -149,6 +152,10 @@ namespace Beelzebub { namespace Memory
                     return "Full";
                 case FrameStatus::Reserved:
                     return "Reserved";
+                case FrameStatus::Huge:
+                    return "Huge";
+                case FrameStatus::Spanned:
+                    return "Spanned";
 
                 default:
                     return "UNKNOWN";
@@ -169,6 +176,10 @@ namespace Beelzebub { namespace Memory
                     return 'L';
                 case FrameStatus::Reserved:
                     return 'R';
+                case FrameStatus::Huge:
+                    return 'H';
+                case FrameStatus::Spanned:
+                    return 'P';
 
                 default:
                     return 'X';
@@ -271,6 +282,9 @@ namespace Beelzebub { namespace Memory
 
         static constexpr uint16_t const SubDescriptorsCount = 511;
 
+        //  Number of large frames which make up a 1-GiB frame.
+        static constexpr uint32_t const HugeSpan = 512;
+
         /*  Fields & Properties  */
 
         uint16_t Padding1;
@@ -359,11 +373,13 @@ namespace Beelzebub { namespace Memory
 
         PROP( size_t, LargeFrameCount)      //  Total number of large frames in this space.
 
+        PROP(NumaNode, Node)                //  Proximity domain of the memory in this space.
+
     public:
 
         /*  Constructors    */
 
-        FrameAllocationSpace(paddr_t phys_start, paddr_t phys_end);
+        FrameAllocationSpace(paddr_t phys_start, paddr_t phys_end, NumaNode node = NumaNode::Any);
 
         FrameAllocationSpace(FrameAllocationSpace const &) = delete;
         FrameAllocationSpace & operator =(FrameAllocationSpace const &) = delete;
@@ -371,8 +387,13 @@ namespace Beelzebub { namespace Memory
         /*  Frame manipulation  */
 
         __hot paddr_t AllocateFrame(FrameSize size, uint32_t refCnt);
+        __hot size_t AllocateFrames(FrameSize size, paddr_t * addrs, size_t count, uint32_t refCnt);
+        paddr_t AllocateHugeFrame(uint32_t refCnt);
+        paddr_t AllocateContiguous(psize_t size, psize_t alignment, uint32_t refCnt);
+        __hot void FreeFrames(FrameSize size, paddr_t const * addrs, size_t count);
 
         __hot Handle Mingle(paddr_t addr, uint32_t & newCnt, int32_t diff, bool ignoreRefCnt);
+        __hot Handle Detach(paddr_t addr, uint32_t & newCnt, int32_t diff, bool ignoreRefCnt, FrameSize & size);
         __cold Handle ReserveRange(paddr_t start, psize_t size, bool includeBusy);
 
         Handle GetFrameInfo(paddr_t addr, FrameSize & size, uint32_t & refCnt);
@@ -383,6 +404,14 @@ namespace Beelzebub { namespace Memory
                 && ((start + size) <= this->AllocationEnd);
         }
 
+    private:
+        __hot bool FreeSmallFrame(uint32_t lIndex, LargeFrameDescriptor * lDesc, uint16_t sIndex, SmallFrameDescriptor * sDesc);
+        void FreeHugeFrame(uint32_t lIndex);
+        uint32_t ClaimLargeRun(uint32_t count, uint32_t align);
+        uint32_t GetHugeFrameHead(uint32_t lIndex) const;
+
+    public:
+
         /*  Fields  */
 
         LargeFrameDescriptor * Map;
@@ -435,9 +464,13 @@ namespace Beelzebub { namespace Memory
 
         /*  Page Manipulation  */
 
-        __hot paddr_t AllocateFrame(FrameSize size, AddressMagnitude magn, uint32_t refCnt);
+        __hot paddr_t AllocateFrame(FrameSize size, AddressMagnitude magn, uint32_t refCnt, NumaNode node = NumaNode::Any);
+        __hot size_t AllocateFrames(FrameSize size, AddressMagnitude magn, paddr_t * addrs, size_t count, uint32_t refCnt, NumaNode node = NumaNode::Any);
+        paddr_t AllocateContiguous(psize_t size, psize_t alignment, AddressMagnitude magn, uint32_t refCnt, NumaNode node = NumaNode::Any);
+        __hot void FreeFrames(FrameSize size, paddr_t const * addrs, size_t count);
 
         __hot Handle Mingle(paddr_t addr, uint32_t & newCnt, int32_t diff, bool ignoreRefCnt);
+        __hot Handle Detach(paddr_t addr, uint32_t & newCnt, int32_t diff, bool ignoreRefCnt, FrameSize & size);
         __cold Handle ReserveRange(paddr_t start, psize_t size, bool includeBusy);
 
         Handle GetFrameInfo(paddr_t addr, FrameSize & size, uint32_t & refCnt);
@@ -477,7 +510,15 @@ namespace Beelzebub { namespace Memory
 
         /*  Initialization  */
 
-        static __cold Handle CreateAllocationSpace(paddr_t start, paddr_t end);
+        static __cold Handle CreateAllocationSpace(paddr_t start, paddr_t end, NumaNode node = NumaNode::Any);
+
+        /**
+         *  <summary>
+         *  Reserves a kernel page through which the current core can access
+         *  arbitrary frames, with its page tables already in place.
+         *  </summary>
+         */
+        static __cold Handle CreateFrameWindow(vaddr_t & window);
 
         /*  Relocation  */
 
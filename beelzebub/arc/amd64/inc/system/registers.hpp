@@ -61,13 +61,15 @@ namespace Beelzebub { namespace System
          *  Bit structure with PCID enabled:
          *       0 -  11 : PCID
          *      12 - M-1 : Physical address of PML4 table; 4-KiB aligned.
-         *       M -  63 : Reserved (must be 0)
+         *       M -  62 : Reserved (must be 0)
+         *      63       : No-flush (only when written; preserves the PCID's TLB entries)
          */
 
         /*  Properties  */
 
         BITFIELD_DEFAULT_1W( 3, Pwt)
         BITFIELD_DEFAULT_1W( 4, Pcd)
+        BITFIELD_DEFAULT_1W(63, NoFlush)
 
         static uint64_t const AddressBits   = 0x000FFFFFFFFFF000ULL;
         static uint64_t const PcidBits      = 0x0000000000000FFFULL;
@@ -39,6 +39,7 @@
 
 #include "cores.hpp"
 #include "memory/vmm.hpp"
+#include "memory/pmm.arc.hpp"
 #include "system/cpu.hpp"
 #include "kernel.image.hpp"
 #include "kernel.hpp"
@@ -186,6 +187,14 @@ void Cores::Register()
 
     CreateStacks(data);
 
+    //  And the window for clearing frames.
+
+    Handle res = PmmArc::CreateFrameWindow(data->FrameWindow);
+
+    ASSERT(res.IsOkayResult()
+        , "Failed to create the frame window of core #%us: %H."
+        , index, res);
+
     //  And finally, prepare the TLS area!
 
     if (KernelImage::Elf.TLS_64 != nullptr)
@@ -57,6 +57,7 @@
 #include "system/timers/pit.hpp"
 #include "system/cpu.hpp"
 #include "system/fpu.hpp"
+#include "system/acpi.hpp"
 
 #include "initrd.hpp"
 #include "kernel.image.hpp"
@@ -178,6 +179,31 @@ Handle Beelzebub::ParseKernelArguments()
     PHYSICAL MEMORY
 **********************/
 
+/**
+ *  <summary>
+ *  Creates allocation spaces over the given range, split at the boundaries of
+ *  the proximity domains described by the SRAT.
+ *  </summary>
+ */
+static __startup void CreateAllocationSpaces(paddr_t start, paddr_t const end)
+{
+    while (start < end)
+    {
+        uint32_t domain = 0;
+        paddr_t next;
+
+        Handle const res = Acpi::GetMemoryAffinity(start, domain, next);
+
+        if (next == nullpaddr || next > end)
+            next = end;
+
+        PmmArc::CreateAllocationSpace(start, next
+            , res.IsOkayResult() ? (NumaNode)domain : NumaNode::Any);
+
+        start = next;
+    }
+}
+
 /**
  *  <summary>
  *  Sanitizes the memory map and initializes the page allocator over the local
@@ -259,11 +285,9 @@ __startup Handle InitializePhysicalAllocator(jg_info_mmap_t * map // TODO: Don't
         {
             if (m->address < start.Value && (m->address + m->length) > start.Value)
                 //  Means this entry crosses the start of free memory.
-                //CreateAllocationSpace(start, m->address + m->length, domain);
-                PmmArc::CreateAllocationSpace(start, paddr_t(m->address + m->length));
+                CreateAllocationSpaces(start, paddr_t(m->address + m->length));
             else
-                //CreateAllocationSpace(m->address, m->address + m->length, domain);
-                PmmArc::CreateAllocationSpace(paddr_t(m->address), paddr_t(m->address + m->length));
+                CreateAllocationSpaces(paddr_t(m->address), paddr_t(m->address + m->length));
         }
 
     //  PAGE RESERVATION
@@ -372,9 +396,13 @@ Handle Beelzebub::InitializeVirtualMemory()
 
     VmmArc::Page1GB = BootstrapCpuid.CheckFeature(CpuFeature::Page1GB);
     VmmArc::NX      = BootstrapCpuid.CheckFeature(CpuFeature::NX     );
+    VmmArc::PCID    = BootstrapCpuid.CheckFeature(CpuFeature::PCID   ) && Cpu::GetCr4().GetPge();
+    //  Tagging relies on shared kernel mappings being global.
 
     Vmm::Bootstrap(&BootstrapProcess);
     ++BootstrapProcess.ActiveCoreCount;
+    BootstrapProcess.SetActiveCore(0, true);
+    //  The bootstrap core is the first to register.
 
     RemapTerminal(MainTerminal);
 
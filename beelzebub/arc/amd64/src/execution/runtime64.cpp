@@ -43,6 +43,7 @@
 #include <memory/vmm.hpp>
 #include <system/cpu.hpp>
 #include <kernel.hpp>
+#include <clock.hpp>
 
 #include <string.h>
 #include <debug.hpp>
@@ -50,6 +51,7 @@
 using namespace Beelzebub;
 using namespace Beelzebub::Execution;
 using namespace Beelzebub::Memory;
+using namespace Beelzebub::System;
 
 static bool HeaderValidator(ElfHeader1 const * header, void * data)
 {
@@ -58,6 +60,40 @@ static bool HeaderValidator(ElfHeader1 const * header, void * data)
     return header->Identification.Class == ElfClass::Elf64;
 }
 
+static Handle MapTimePage(vaddr_t vaddr)
+{
+    Process * proc = Cpu::GetProcess();
+
+    Handle res = Vmm::AllocatePages(proc
+        , vsize_t(PageSize.Value)
+        , MemoryAllocationOptions::Used | MemoryAllocationOptions::VirtualUser
+        | MemoryAllocationOptions::Permanent
+        , MemoryFlags::Userland
+        , MemoryContent::Runtime
+        , vaddr);
+
+    assert_or(res.IsOkayResult()
+        , "Failed to reserve the time page at %Xp: %H."
+        , vaddr, res)
+    {
+        return res;
+    }
+
+    res = Vmm::MapPage(proc, vaddr, Clock::SharedPagePaddr, MemoryFlags::Userland);
+    //  Read-only for the userland; the kernel writes through its own mapping.
+
+    assert_or(res.IsOkayResult()
+        , "Failed to map the time page at %Xp (%XP): %H."
+        , vaddr, Clock::SharedPagePaddr, res)
+    {
+        Vmm::FreePages(proc, vaddr, vsize_t(PageSize.Value));
+
+        return res;
+    }
+
+    return HandleResult::Okay;
+}
+
 /**********************
     Runtime64 class
 **********************/
@@ -87,17 +123,14 @@ Handle Runtime64::Initialize()
     
     if (bnd.Start % PageSize == 0 && bnd.AlignedSize % PageSize == 0)
     {
-        for (vsize_t offset { 0 }; offset < bnd.Size; offset += PageSize)
-        {
-            Handle res = Vmm::SetPageFlags(&BootstrapProcess, bnd.Start + offset
-                , MemoryFlags::Global | MemoryFlags::Userland);
-            //  Modules are normally global-supervisor-writable. This one needs to
-            //  be global-userland-readable.
-
-            ASSERTX(res.IsOkayResult()
-                , "Failed to change page flags for 64-bit runtime module.")
-                ("page", bnd.Start + offset)(res)XEND;
-        }
+        Handle res = Vmm::SetRangeFlags(&BootstrapProcess, bnd.Start
+            , RoundUp(bnd.Size, PageSize), MemoryFlags::Global | MemoryFlags::Userland);
+        //  Modules are normally global-supervisor-writable. This one needs to
+        //  be global-userland-readable.
+
+        ASSERTX(res.IsOkayResult()
+            , "Failed to change page flags for 64-bit runtime module.")
+            ("start", bnd.Start)("size", bnd.Size)(res)XEND;
 
         new (&Template) Elf(bnd.Start, bnd.Size);
     }
@@ -189,6 +222,17 @@ Handle Runtime64::Deploy(uintptr_t base, StartupData * & data)
     stdat->RuntimeImage = copy;
     //  Aye, copy the ELF class into the userland.
 
+    stdat->Time = nullptr;
+
+    if (Clock::SharedPage != nullptr)
+    {
+        Handle res = MapTimePage(vaddr_t(base - PageSize.Value));
+
+        if likely(res.IsOkayResult())
+            stdat->Time = reinterpret_cast<Execution::TimePage const *>(base - PageSize.Value);
+        //  Without it, the runtime merely falls back to slower means.
+    }
+
     data = stdat;
 
     return HandleResult::Okay;
@@ -101,7 +101,5 @@ Handle Beelzebub::Execution::InitializeBootstrapThread(Thread * const bst, Proce
     bst->KernelStackBottom = 0xFFFFFFFFFFFFC000U;//RoundDown((uintptr_t)&dummy, PageSize);
     bst->KernelStackTop = 0xFFFFFFFFFFFFF000U;//RoundUp((uintptr_t)&dummy, PageSize);
 
-    bst->Next = bst->Previous = bst;
-
     return HandleResult::Okay;
 }
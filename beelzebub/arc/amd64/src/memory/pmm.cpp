@@ -39,7 +39,10 @@
 
 #include <memory/pmm.hpp>
 #include <memory/pmm.arc.hpp>
+#include <memory/vmm.hpp>
 #include <system/cpu.hpp>
+#include <system/acpi.hpp>
+#include <cores.hpp>
 #include <kernel.hpp>
 
 #include <math.h>
@@ -81,6 +84,219 @@ static __hot void SplitLargeFrame(LargeFrameDescriptor * desc, uint16_t cnt = La
     desc->GetExtras()->FreeCount = cnt;
 }
 
+/*  NUMA  */
+
+uint32_t Pmm::GetNodeDistance(NumaNode from, NumaNode to)
+{
+    if (from == to)
+        return 10;
+    else if (from == NumaNode::Any || to == NumaNode::Any)
+        return 20;
+    //  Memory of unknown affinity is considered remote.
+
+    return Acpi::GetLocalityDistance((uint32_t)from, (uint32_t)to);
+}
+
+static __forceinline bool FitsMagnitude(FrameAllocationSpace const * space, AddressMagnitude magn)
+{
+    return magn != AddressMagnitude::_32bit || space->GetAllocationEnd() <= (1ULL << 32);
+    //  The condition checks that the allocation space ends at a 32-bit
+    //  address. (all the other addresses are less, thus have to be 32-bit if
+    //  the end is)
+}
+
+/**
+ *  <summary>
+ *  Visits the allocation spaces suitable for the given magnitude, in order of
+ *  distance from the given node, until the visitor returns true.
+ *  </summary>
+ *  <return>True if the visitor returned true; otherwise false.</return>
+ */
+template<typename TVisitor>
+static __hot bool VisitSpaces(FrameAllocator * alloc, AddressMagnitude magn, NumaNode node, TVisitor visitor)
+{
+    if (node == NumaNode::Any)
+    {
+        for (FrameAllocationSpace * space = alloc->LastSpace; space != nullptr; space = space->Previous)
+            if (FitsMagnitude(space, magn) && visitor(space))
+                return true;
+
+        return false;
+    }
+
+    int64_t floor = -1;
+
+    while (true)
+    {
+        uint32_t dist = UINT32_MAX;
+
+        for (FrameAllocationSpace * space = alloc->LastSpace; space != nullptr; space = space->Previous)
+            if (FitsMagnitude(space, magn))
+            {
+                uint32_t const d = Pmm::GetNodeDistance(node, space->GetNode());
+
+                if ((int64_t)d > floor && d < dist)
+                    dist = d;
+            }
+
+        if (dist == UINT32_MAX)
+            return false;
+        //  Every node has been tried.
+
+        for (FrameAllocationSpace * space = alloc->LastSpace; space != nullptr; space = space->Previous)
+            if (FitsMagnitude(space, magn)
+                && Pmm::GetNodeDistance(node, space->GetNode()) == dist
+                && visitor(space))
+                return true;
+
+        floor = dist;
+    }
+}
+
+/*  Frame Magazines  */
+
+template<size_t N>
+static __hot paddr_t PopMagazine(FrameMagazine<N> & mag, FrameSize size, NumaNode node)
+{
+    if unlikely(mag.Count == 0)
+        mag.Count = PmmArc::MainAllocator->AllocateFrames(size, AddressMagnitude::Any, mag.Frames, mag.Batch, 0, node);
+
+    if unlikely(mag.Count == 0)
+        return nullpaddr;
+
+    return mag.Frames[--mag.Count];
+}
+
+template<size_t N>
+static __hot void PushMagazine(FrameMagazine<N> & mag, FrameSize size, paddr_t addr)
+{
+    if unlikely(mag.Count == mag.Capacity)
+    {
+        //  The bottom of the stack holds the coldest frames, so those go back.
+
+        PmmArc::MainAllocator->FreeFrames(size, mag.Frames, mag.Batch);
+
+        mag.Count -= mag.Batch;
+
+        for (size_t i = 0; i < mag.Count; ++i)
+            mag.Frames[i] = mag.Frames[i + mag.Batch];
+    }
+
+    mag.Frames[mag.Count++] = addr;
+}
+
+static __hot Handle ReleaseFrame(paddr_t addr, uint32_t & newCnt, int32_t diff, bool ignoreRefCnt)
+{
+    if unlikely(!Cores::IsReady())
+        return PmmArc::MainAllocator->Mingle(addr, newCnt, diff, ignoreRefCnt);
+    //  There are no magazines until every core has its data.
+
+    FrameSize size;
+
+    Handle res = PmmArc::MainAllocator->Detach(addr, newCnt, diff, ignoreRefCnt, size);
+
+    if (!res.IsOkayResult() || newCnt != 0)
+        return res;
+
+    //  So the frame has no more references and it belongs to the caller now.
+
+    if (size == FrameSize::_2MiB)
+        addr = RoundDown(addr, LargePageSize);
+    //  Small pages split off a large page refer to it by any address within.
+
+    if unlikely(size == FrameSize::_1GiB)
+    {
+        addr = RoundDown(addr, HugePageSize);
+        //  So do the pages split off a huge page.
+
+        PmmArc::MainAllocator->FreeFrames(size, &addr, 1);
+        //  These are never cached.
+
+        return HandleResult::Okay;
+    }
+
+    NumaNode const local = Pmm::GetLocalNode();
+
+    if unlikely(local != NumaNode::Any && PmmArc::MainAllocator->GetSpace(addr)->GetNode() != local)
+    {
+        PmmArc::MainAllocator->FreeFrames(size, &addr, 1);
+        //  Frames of other nodes go straight home, so magazines stay local.
+
+        return HandleResult::Okay;
+    }
+
+    InterruptGuard<> intGuard;
+
+    CpuData * const data = Cpu::GetData();
+
+    if (size == FrameSize::_4KiB)
+        PushMagazine(data->SmallFrames, size, addr);
+    else
+        PushMagazine(data->LargeFrames, size, addr);
+
+    return HandleResult::Okay;
+}
+
+/*  Zeroed Frames  */
+
+static constexpr size_t const ZeroedPoolCapacity = 256;
+
+static SmpLockUni ZeroedPoolLock {};
+static size_t ZeroedPoolCount = 0;
+static paddr_t ZeroedPool[ZeroedPoolCapacity];
+
+/**
+ *  <summary>
+ *  Clears a frame through the current core's window, with non-temporal stores
+ *  so the zeros don't evict anything useful from the cache.
+ *  </summary>
+ */
+static __hot void ClearFrame(paddr_t addr, FrameSize size)
+{
+    InterruptGuard<> intGuard;
+
+    vaddr_t const window = Cpu::GetData()->FrameWindow;
+
+    ASSERT(window != nullvaddr, "Core #%us has no frame window.", Cpu::GetData()->Index);
+
+    psize_t const length { size == FrameSize::_4KiB ? PageSize.Value
+                         : (size == FrameSize::_2MiB ? LargePageSize.Value : HugePageSize.Value) };
+
+    for (psize_t offset { 0 }; offset < length; offset += PageSize)
+    {
+        Handle res = Vmm::MapPage(nullptr, window, addr + offset, MemoryFlags::Global | MemoryFlags::Writable
+            , MemoryMapOptions::NoLocking | MemoryMapOptions::NoReferenceCounting);
+
+        ASSERT(res.IsOkayResult()
+            , "Failed to map frame %XP in the window of core #%us: %H."
+            , addr + offset, Cpu::GetData()->Index, res);
+
+        uintptr_t * const words = reinterpret_cast<uintptr_t *>(window.Value);
+
+        for (size_t i = 0; i < PageSize.Value / sizeof(uintptr_t); i += 8)
+        {
+            CpuInstructions::StoreNonTemporal(words + i + 0, 0);
+            CpuInstructions::StoreNonTemporal(words + i + 1, 0);
+            CpuInstructions::StoreNonTemporal(words + i + 2, 0);
+            CpuInstructions::StoreNonTemporal(words + i + 3, 0);
+            CpuInstructions::StoreNonTemporal(words + i + 4, 0);
+            CpuInstructions::StoreNonTemporal(words + i + 5, 0);
+            CpuInstructions::StoreNonTemporal(words + i + 6, 0);
+            CpuInstructions::StoreNonTemporal(words + i + 7, 0);
+        }
+
+        CpuInstructions::StoreFence();
+        //  Non-temporal stores are weakly ordered.
+
+        paddr_t dummyAddr;
+        FrameSize dummySize;
+
+        Vmm::UnmapPage(nullptr, window, dummyAddr, dummySize
+            , MemoryMapOptions::NoLocking | MemoryMapOptions::NoReferenceCounting | MemoryMapOptions::NoBroadcasting);
+        //  No other core ever uses this window.
+    }
+}
+
 /*******************
     PmmArc class
 *******************/
@@ -100,16 +316,318 @@ FrameAllocator * PmmArc::MainAllocator = nullptr;
 
 paddr_t Pmm::AllocateFrame(FrameSize size, AddressMagnitude magn, uint32_t refCnt)
 {
-    //  TODO: NUMA selection of some sorts, maybe based on process?
+    return AllocateFrame(GetLocalNode(), size, magn, refCnt);
+}
+
+paddr_t Pmm::AllocateFrame(NumaNode node, FrameSize size, AddressMagnitude magn, uint32_t refCnt)
+{
+    if likely(Cores::IsReady()
+        && (magn == AddressMagnitude::Any || magn == AddressMagnitude::_48bit)
+        && (size == FrameSize::_4KiB || size == FrameSize::_2MiB))
+    {
+        paddr_t ret = nullpaddr;
+        bool cached = false;
+
+        withInterrupts (false)
+        {
+            CpuData * const data = Cpu::GetData();
+
+            if likely(node == NumaNode::Any || node == data->Node)
+            {
+                //  Magazines only hold frames of the local node.
+
+                cached = true;
+
+                if (size == FrameSize::_4KiB)
+                    ret = PopMagazine(data->SmallFrames, size, data->Node);
+                else
+                    ret = PopMagazine(data->LargeFrames, size, data->Node);
+            }
+        }
+
+        if (cached)
+        {
+            if likely(ret != nullpaddr && refCnt != 0)
+            {
+                uint32_t dummy;
+                FrameSize dummySize;
+
+                PmmArc::MainAllocator->Detach(ret, dummy, (int32_t)refCnt, false, dummySize);
+                //  Frames in a magazine have no references, so this sets the count.
+            }
+
+            return ret;
+        }
+    }
+
+    return PmmArc::MainAllocator->AllocateFrame(size, magn, refCnt, node);
+}
+
+paddr_t Pmm::AllocateFrame(FrameAllocationOptions opts, FrameSize size, AddressMagnitude magn, uint32_t refCnt)
+{
+    if (0 == (opts & FrameAllocationOptions::Zeroed))
+        return AllocateFrame(size, magn, refCnt);
+
+    paddr_t ret = nullpaddr;
+
+    if likely(size == FrameSize::_4KiB
+        && (magn == AddressMagnitude::Any || magn == AddressMagnitude::_48bit))
+    {
+        withInterrupts (false)
+            withLock (ZeroedPoolLock)
+                if likely(ZeroedPoolCount > 0)
+                    ret = ZeroedPool[--ZeroedPoolCount];
+
+        if likely(ret != nullpaddr)
+        {
+            if (refCnt != 0)
+            {
+                uint32_t dummy;
+                FrameSize dummySize;
+
+                PmmArc::MainAllocator->Detach(ret, dummy, (int32_t)refCnt, false, dummySize);
+                //  Frames in the pool have no references, so this sets the count.
+            }
+
+            return ret;
+        }
+    }
+
+    ret = AllocateFrame(size, magn, refCnt);
+
+    if likely(ret != nullpaddr)
+        ClearFrame(ret, size);
+    //  The pool ran dry, so the caller pays for the clearing.
+
+    return ret;
+}
+
+NumaNode Pmm::GetLocalNode()
+{
+    if likely(Cores::IsReady())
+        return Cpu::GetData()->Node;
+
+    return NumaNode::Any;
+}
+
+NumaNode Pmm::GetFrameNode(paddr_t addr)
+{
+    FrameAllocationSpace const * const space = PmmArc::MainAllocator->GetSpace(addr);
+
+    return space == nullptr ? NumaNode::Any : space->GetNode();
+}
+
+size_t Pmm::AllocateFrames(size_t count, FrameSize size, paddr_t * addrs, AddressMagnitude magn, uint32_t refCnt)
+{
+    size_t done = 0;
+
+    if likely(Cores::IsReady()
+        && (magn == AddressMagnitude::Any || magn == AddressMagnitude::_48bit)
+        && (size == FrameSize::_4KiB || size == FrameSize::_2MiB))
+    {
+        //  Whatever this core has cached goes first.
+
+        withInterrupts (false)
+        {
+            CpuData * const data = Cpu::GetData();
+
+            if (size == FrameSize::_4KiB)
+                while (done < count && data->SmallFrames.Count > 0)
+                    addrs[done++] = data->SmallFrames.Frames[--data->SmallFrames.Count];
+            else
+                while (done < count && data->LargeFrames.Count > 0)
+                    addrs[done++] = data->LargeFrames.Frames[--data->LargeFrames.Count];
+        }
+
+        if (refCnt != 0)
+            for (size_t i = 0; i < done; ++i)
+            {
+                uint32_t dummy;
+                FrameSize dummySize;
+
+                PmmArc::MainAllocator->Detach(addrs[i], dummy, (int32_t)refCnt, false, dummySize);
+            }
+    }
 
-    return PmmArc::MainAllocator->AllocateFrame(size, magn, refCnt);
+    if (done < count)
+        done += PmmArc::MainAllocator->AllocateFrames(size, magn, addrs + done, count - done, refCnt, GetLocalNode());
+
+    return done;
+}
+
+size_t Pmm::AllocateFrames(FrameAllocationOptions opts, size_t count, FrameSize size, paddr_t * addrs, AddressMagnitude magn, uint32_t refCnt)
+{
+    if (0 == (opts & FrameAllocationOptions::Zeroed))
+        return AllocateFrames(count, size, addrs, magn, refCnt);
+
+    size_t pooled = 0;
+
+    if likely(size == FrameSize::_4KiB
+        && (magn == AddressMagnitude::Any || magn == AddressMagnitude::_48bit))
+    {
+        withInterrupts (false)
+            withLock (ZeroedPoolLock)
+                while (pooled < count && ZeroedPoolCount > 0)
+                    addrs[pooled++] = ZeroedPool[--ZeroedPoolCount];
+
+        if (refCnt != 0)
+            for (size_t i = 0; i < pooled; ++i)
+            {
+                uint32_t dummy;
+                FrameSize dummySize;
+
+                PmmArc::MainAllocator->Detach(addrs[i], dummy, (int32_t)refCnt, false, dummySize);
+            }
+    }
+
+    if (pooled == count)
+        return count;
+
+    size_t const done = pooled + AllocateFrames(count - pooled, size, addrs + pooled, magn, refCnt);
+
+    for (size_t i = pooled; i < done; ++i)
+        ClearFrame(addrs[i], size);
+    //  The pool couldn't cover these.
+
+    return done;
+}
+
+paddr_t Pmm::AllocateContiguous(psize_t size, psize_t alignment, AddressMagnitude magn, uint32_t refCnt)
+{
+    if unlikely(size == psize_t(0) || (alignment.Value & (alignment.Value - 1)) != 0)
+        return nullpaddr;
+    //  Alignments must be powers of two.
+
+    return PmmArc::MainAllocator->AllocateContiguous(size, alignment, magn, refCnt, GetLocalNode());
+}
+
+Handle Pmm::FreeContiguous(paddr_t addr, psize_t size, bool ignoreRefCnt)
+{
+    FrameSize fSize;
+    uint32_t dummy;
+
+    Handle res = PmmArc::MainAllocator->GetFrameInfo(addr, fSize, dummy);
+
+    if unlikely(!res.IsOkayResult())
+        return res;
+
+    //  The size of the first frame tells how the block was rounded.
+
+    psize_t step, length;
+
+    if (fSize == FrameSize::_4KiB)
+    {
+        step = PageSize;
+        length = psize_t(PageSize.Value << FastCeilLog2<uint64_t>(RoundUp(size.Value, PageSize.Value) >> 12));
+    }
+    else
+    {
+        step = LargePageSize;
+        length = psize_t(RoundUp(size.Value, LargePageSize.Value));
+    }
+
+    for (psize_t offset { 0 }; offset < length; offset += step)
+    {
+        Handle const r = FreeFrame(addr + offset, ignoreRefCnt);
+
+        if unlikely(!r.IsOkayResult() && res.IsOkayResult())
+            res = r;
+    }
+
+    return res;
 }
 
 Handle Pmm::FreeFrame(paddr_t addr, bool ignoreRefCnt)
 {
     uint32_t dummy;
 
-    return PmmArc::MainAllocator->Mingle(addr, dummy, 0, ignoreRefCnt);
+    return ReleaseFrame(addr, dummy, 0, ignoreRefCnt);
+}
+
+/**
+ *  <summary>
+ *  Detaches the given frames, adjusting their reference counts by the given
+ *  difference (or resetting them if zero), and frees in batches those left
+ *  without references.
+ *  </summary>
+ */
+static __hot Handle DetachFrames(paddr_t const * addrs, size_t count, int32_t diff, bool ignoreRefCnt)
+{
+    static constexpr size_t const SmallBatchSize = 16, LargeBatchSize = 8;
+    //  Kept short, as this runs on kernel stacks. Large frames are rarer.
+
+    paddr_t small[SmallBatchSize], large[LargeBatchSize];
+    size_t smallCnt = 0, largeCnt = 0;
+    Handle res = HandleResult::Okay;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        uint32_t newCnt;
+        FrameSize size;
+
+        Handle const r = PmmArc::MainAllocator->Detach(addrs[i], newCnt, diff, ignoreRefCnt, size);
+        //  No locks are taken here; frames that can be freed end up owned.
+
+        if unlikely(!r.IsOkayResult())
+        {
+            if (res.IsOkayResult())
+                res = r;
+
+            continue;
+        }
+
+        if (newCnt != 0)
+            continue;
+        //  Still referenced elsewhere.
+
+        if unlikely(size == FrameSize::_1GiB)
+        {
+            paddr_t const head = RoundDown(addrs[i], HugePageSize);
+
+            PmmArc::MainAllocator->FreeFrames(size, &head, 1);
+            //  Pages split off a huge page refer to it by any address within.
+        }
+        else if (size == FrameSize::_4KiB)
+        {
+            small[smallCnt++] = addrs[i];
+
+            if unlikely(smallCnt == SmallBatchSize)
+            {
+                PmmArc::MainAllocator->FreeFrames(FrameSize::_4KiB, small, smallCnt);
+
+                smallCnt = 0;
+            }
+        }
+        else
+        {
+            large[largeCnt++] = RoundDown(addrs[i], LargePageSize);
+            //  Small pages split off a large page refer to it by any address within.
+
+            if unlikely(largeCnt == LargeBatchSize)
+            {
+                PmmArc::MainAllocator->FreeFrames(FrameSize::_2MiB, large, largeCnt);
+
+                largeCnt = 0;
+            }
+        }
+    }
+
+    if (smallCnt > 0)
+        PmmArc::MainAllocator->FreeFrames(FrameSize::_4KiB, small, smallCnt);
+    if (largeCnt > 0)
+        PmmArc::MainAllocator->FreeFrames(FrameSize::_2MiB, large, largeCnt);
+
+    return res;
+}
+
+Handle Pmm::FreeFrames(paddr_t const * addrs, size_t count, bool ignoreRefCnt)
+{
+    return DetachFrames(addrs, count, 0, ignoreRefCnt);
+}
+
+Handle Pmm::ReleaseFrames(paddr_t const * addrs, size_t count)
+{
+    return DetachFrames(addrs, count, -1, false);
 }
 
 Handle Pmm::ReserveRange(paddr_t start, psize_t size, bool includeBusy)
@@ -122,7 +640,7 @@ Handle Pmm::AdjustReferenceCount(paddr_t addr, uint32_t & newCnt, int32_t diff)
     if unlikely(addr == nullpaddr || diff == 0)
         return HandleResult::ArgumentOutOfRange;
 
-    return PmmArc::MainAllocator->Mingle(addr, newCnt, diff, false);
+    return ReleaseFrame(addr, newCnt, diff, false);
 }
 
 Handle Pmm::GetFrameInfo(paddr_t addr, FrameSize & size, uint32_t & refCnt)
@@ -133,13 +651,45 @@ Handle Pmm::GetFrameInfo(paddr_t addr, FrameSize & size, uint32_t & refCnt)
     return PmmArc::MainAllocator->GetFrameInfo(addr, size, refCnt);
 }
 
+/*  Zeroed frames  */
+
+bool Pmm::ReplenishZeroedFrames()
+{
+    if (ZeroedPoolCount >= ZeroedPoolCapacity)
+        return false;
+    //  A stale read only means a frame is cleared in vain.
+
+    paddr_t const frame = AllocateFrame();
+
+    if unlikely(frame == nullpaddr)
+        return false;
+
+    ClearFrame(frame, FrameSize::_4KiB);
+
+    bool stored = false;
+
+    withInterrupts (false)
+        withLock (ZeroedPoolLock)
+            if likely(ZeroedPoolCount < ZeroedPoolCapacity)
+            {
+                ZeroedPool[ZeroedPoolCount++] = frame;
+
+                stored = true;
+            }
+
+    if unlikely(!stored)
+        FreeFrame(frame);
+
+    return stored;
+}
+
 /*******************
     PmmArc class
 *******************/
 
 /*  Initialization  */
 
-Handle PmmArc::CreateAllocationSpace(paddr_t start, paddr_t end)
+Handle PmmArc::CreateAllocationSpace(paddr_t start, paddr_t end, NumaNode node)
 {
     // MSG_("&& Space %XP-%XP (%XS) ", start, end, end - start);
 
@@ -170,7 +720,7 @@ Handle PmmArc::CreateAllocationSpace(paddr_t start, paddr_t end)
         else
             ++PmmArc::AllocationSpace;
 
-        PmmArc::MainAllocator->AppendAllocationSpace(new (PmmArc::AllocationSpace) FrameAllocationSpace(start, end));
+        PmmArc::MainAllocator->AppendAllocationSpace(new (PmmArc::AllocationSpace) FrameAllocationSpace(start, end, node));
 
         return HandleResult::Okay;
     }
@@ -185,12 +735,32 @@ Handle PmmArc::CreateAllocationSpace(paddr_t start, paddr_t end)
 
         PmmArc::TempSpaceLimit = start + PageSize;
 
-        new (PmmArc::MainAllocator) FrameAllocator(new (PmmArc::AllocationSpace) FrameAllocationSpace(start + PageSize, end));
+        new (PmmArc::MainAllocator) FrameAllocator(new (PmmArc::AllocationSpace) FrameAllocationSpace(start + PageSize, end, node));
 
         return HandleResult::Okay;
     }
 }
 
+Handle PmmArc::CreateFrameWindow(vaddr_t & window)
+{
+    Handle res = Vmm::AllocatePages(nullptr
+        , PageSize
+        , MemoryAllocationOptions::Commit | MemoryAllocationOptions::VirtualKernelHeap
+        , MemoryFlags::Global | MemoryFlags::Writable
+        , MemoryContent::Generic
+        , window);
+
+    if unlikely(!res.IsOkayResult())
+        return res;
+
+    //  Committing created the page tables; now the page is given back.
+
+    paddr_t dummyAddr;
+    FrameSize dummySize;
+
+    return Vmm::UnmapPage(nullptr, window, dummyAddr, dummySize);
+}
+
 /*  Relocation  */
 
 void PmmArc::Remap(FrameAllocator * & alloc, vaddr_t const oldVaddr, vaddr_t const newVaddr)
@@ -237,11 +807,12 @@ void PmmArc::Remap(FrameAllocator * & alloc, vaddr_t const oldVaddr, vaddr_t con
 
 /*  Constructor(s)  */
 
-FrameAllocationSpace::FrameAllocationSpace(paddr_t phys_start, paddr_t phys_end)
+FrameAllocationSpace::FrameAllocationSpace(paddr_t phys_start, paddr_t phys_end, NumaNode node)
     : MemoryStart( phys_start)
     , MemoryEnd(phys_end)
     , Size(phys_end - phys_start)
     , ReservedSize(0)
+    , Node(node)
     , Map(reinterpret_cast<LargeFrameDescriptor *>(phys_start.Value))
     , LargeLocker()
     , SplitLocker()
@@ -345,11 +916,13 @@ paddr_t FrameAllocationSpace::AllocateFrame(FrameSize size, uint32_t refCnt)
     {
     case FrameSize::_64KiB: //  TODO: Use 4-KiB frames to provide this.
     case FrameSize::_4MiB:  //  TODO: Use 2-MiB frames to provide this.
-    case FrameSize::_1GiB:
         FAIL("A request was made for a frame size which is not supported by this architecture.");
 
         return nullpaddr;
 
+    case FrameSize::_1GiB:
+        return this->AllocateHugeFrame(refCnt);
+
     default:
         break;
     }
@@ -380,87 +953,508 @@ paddr_t FrameAllocationSpace::AllocateFrame(FrameSize size, uint32_t refCnt)
             sIndex = lDesc->GetExtras()->NextFree;
             SmallFrameDescriptor * const sDesc = lDesc->SubDescriptors + sIndex;
 
-            assert_or(sIndex != SmallFrameDescriptor::NullIndex
-                , "Invalid split frame state!")
-            {
-                //  This should *not* happen, ever.
+            assert_or(sIndex != SmallFrameDescriptor::NullIndex
+                , "Invalid split frame state!")
+            {
+                //  This should *not* happen, ever.
+
+                goto split_frame_full;
+            }
+
+            // MSG_("   Small frame index: %u2 (-> %u2)%n", sIndex, sDesc->NextIndex);
+
+            sDesc->Use(refCnt);
+
+            lDesc->GetExtras()->NextFree = sDesc->NextIndex;
+            lDesc->GetExtras()->FreeCount -= 1;
+
+            if unlikely(sDesc->NextIndex == SmallFrameDescriptor::NullIndex)
+            {
+                //  This was the last small frame in the split frame.
+
+            split_frame_full:
+                lDesc->Status = FrameStatus::Full;
+
+                uint32_t next = lDesc->NextIndex;
+                this->SplitFree = next;
+
+                if likely(next != LargeFrameDescriptor::NullIndex)
+                    this->Map[next].GetExtras()->PrevIndex = LargeFrameDescriptor::NullIndex;
+                //  No more previous frame for the next frame.
+
+                // MSG_("   Split frame depleted; Next: %u4%n", this->SplitFree);
+
+                onRelease if (sIndex == SmallFrameDescriptor::NullIndex)
+                    goto grab_large_page;
+                //  In release mode, this rather odd situation is tolerated.
+            }
+        }
+
+        // MSG_("   Returning address %XP **%n", this->AllocationStart + (lIndex << 21) + (sIndex << 12));
+
+        return this->AllocationStart + psize_t(lIndex << 21) + psize_t(sIndex << 12);
+    }
+
+grab_large_page:
+    withLock (this->LargeLocker)
+    {
+        lIndex = this->LargeFree;
+
+        if (lIndex == LargeFrameDescriptor::NullIndex)
+            return nullpaddr;
+
+        //  Reaching this point means a non-full split frame exists!
+
+        lDesc = this->Map + lIndex;
+
+        this->LargeFree = lDesc->NextIndex;
+        paddr = this->AllocationStart + psize_t(lIndex << 21);
+
+        if (size == FrameSize::_2MiB)
+        {
+            lDesc->Use(refCnt);
+
+            return paddr;
+        }
+    }
+
+    //  At this point, `lIndex`, `paddr` and `lDesc` are valid.
+
+    SplitLargeFrame(lDesc);
+
+    sIndex = lDesc->GetExtras()->NextFree;
+    SmallFrameDescriptor * const sDesc = lDesc->SubDescriptors + sIndex;
+
+    sDesc->Use(refCnt);
+
+    lDesc->GetExtras()->NextFree = sDesc->NextIndex;
+    lDesc->GetExtras()->FreeCount -= 1;
+
+    withLock (this->SplitLocker)
+    {
+        //  Gotta put this frame on top of the stack.
+
+        uint32_t next = this->SplitFree;
+
+        lDesc->NextIndex = next;
+        this->SplitFree = lIndex;
+
+        if likely(next != LargeFrameDescriptor::NullIndex)
+            this->Map[next].GetExtras()->PrevIndex = lIndex;
+    }
+
+    return this->AllocationStart + psize_t(lIndex << 21) + psize_t(sIndex << 12);
+}
+
+size_t FrameAllocationSpace::AllocateFrames(FrameSize size, paddr_t * addrs, size_t count, uint32_t refCnt)
+{
+    if (size == FrameSize::_1GiB)
+    {
+        size_t done = 0;
+
+        while (done < count && (addrs[done] = this->AllocateHugeFrame(refCnt)) != nullpaddr)
+            ++done;
+
+        return done;
+    }
+
+    if unlikely(size != FrameSize::_4KiB && size != FrameSize::_2MiB)
+    {
+        FAIL("A request was made for a frame size which is not supported by this architecture.");
+
+        return 0;
+    }
+
+    size_t done = 0;
+
+    if (size == FrameSize::_2MiB)
+    {
+        withLock (this->LargeLocker)
+            while (done < count && this->LargeFree != LargeFrameDescriptor::NullIndex)
+            {
+                uint32_t const lIndex = this->LargeFree;
+                LargeFrameDescriptor * const lDesc = this->Map + lIndex;
+
+                this->LargeFree = lDesc->NextIndex;
+                lDesc->Use(refCnt);
+
+                addrs[done++] = this->AllocationStart + psize_t(lIndex << 21);
+            }
+
+        return done;
+    }
+
+    while (true)
+    {
+        withLock (this->SplitLocker)
+            while (done < count && this->SplitFree != LargeFrameDescriptor::NullIndex)
+            {
+                uint32_t const lIndex = this->SplitFree;
+                LargeFrameDescriptor * const lDesc = this->Map + lIndex;
+                SplitFrameExtra * const extra = lDesc->GetExtras();
+                uint16_t const sIndex = extra->NextFree;
+
+                ASSERT(sIndex != SmallFrameDescriptor::NullIndex
+                    , "Invalid split frame state!");
+
+                SmallFrameDescriptor * const sDesc = lDesc->SubDescriptors + sIndex;
+
+                sDesc->Use(refCnt);
+
+                extra->NextFree = sDesc->NextIndex;
+                extra->FreeCount -= 1;
+
+                addrs[done++] = this->AllocationStart + psize_t(lIndex << 21) + psize_t(sIndex << 12);
+
+                if unlikely(extra->NextFree == SmallFrameDescriptor::NullIndex)
+                {
+                    lDesc->Status = FrameStatus::Full;
+
+                    uint32_t next = lDesc->NextIndex;
+                    this->SplitFree = next;
+
+                    if likely(next != LargeFrameDescriptor::NullIndex)
+                        this->Map[next].GetExtras()->PrevIndex = LargeFrameDescriptor::NullIndex;
+                }
+            }
+
+        if (done == count)
+            return done;
+
+        //  The split frames ran dry, so another large frame is split.
+
+        uint32_t lIndex = LargeFrameDescriptor::NullIndex;
+
+        withLock (this->LargeLocker)
+            if likely((lIndex = this->LargeFree) != LargeFrameDescriptor::NullIndex)
+                this->LargeFree = this->Map[lIndex].NextIndex;
+
+        if unlikely(lIndex == LargeFrameDescriptor::NullIndex)
+            return done;
+
+        LargeFrameDescriptor * const lDesc = this->Map + lIndex;
+
+        SplitLargeFrame(lDesc);
+
+        withLock (this->SplitLocker)
+        {
+            uint32_t next = this->SplitFree;
+
+            lDesc->NextIndex = next;
+            this->SplitFree = lIndex;
+
+            if likely(next != LargeFrameDescriptor::NullIndex)
+                this->Map[next].GetExtras()->PrevIndex = lIndex;
+        }
+    }
+}
+
+void FrameAllocationSpace::FreeFrames(FrameSize size, paddr_t const * addrs, size_t count)
+{
+    //  The frames must be in use and owned by the caller; reference counts are
+    //  ignored.
+
+    if (size == FrameSize::_1GiB)
+    {
+        withLock (this->LargeLocker)
+            for (size_t i = 0; i < count; ++i)
+            {
+                uint32_t const lIndex = (uint32_t)((addrs[i] - this->AllocationStart).Value >> 21UL);
+
+                assert(this->Map[lIndex].Status == FrameStatus::Huge)(addrs[i])(this->Map[lIndex].Status);
+
+                this->FreeHugeFrame(lIndex);
+            }
+
+        return;
+    }
+
+    if (size == FrameSize::_2MiB)
+    {
+        withLock (this->LargeLocker)
+            for (size_t i = 0; i < count; ++i)
+            {
+                uint32_t const lIndex = (uint32_t)((addrs[i] - this->AllocationStart).Value >> 21UL);
+                LargeFrameDescriptor * const lDesc = this->Map + lIndex;
+
+                assert(lDesc->Status == FrameStatus::Used)(addrs[i])(lDesc->Status);
+
+                lDesc->Free();
+
+                lDesc->NextIndex = this->LargeFree;
+                this->LargeFree = lIndex;
+            }
+
+        return;
+    }
+
+    uint32_t reclaimedHead = LargeFrameDescriptor::NullIndex;
+    uint32_t reclaimedTail = LargeFrameDescriptor::NullIndex;
+    //  Large frames left entirely free go back in one go afterwards.
+
+    withLock (this->SplitLocker)
+        for (size_t i = 0; i < count; ++i)
+        {
+            uint32_t const lIndex = (uint32_t)((addrs[i] - this->AllocationStart).Value >> 21UL);
+            LargeFrameDescriptor * const lDesc = this->Map + lIndex;
+            uint16_t const sIndex = (uint16_t)((addrs[i].Value & 0x1FF000) >> 12);
+            SmallFrameDescriptor * const sDesc = lDesc->SubDescriptors + sIndex;
+
+            assert(lDesc->IsSplit() && sIndex != 0 && sDesc->Status == FrameStatus::Used)
+                (addrs[i])(lDesc->Status)(sDesc->Status);
+
+            if unlikely(this->FreeSmallFrame(lIndex, lDesc, sIndex, sDesc))
+            {
+                lDesc->Free();
+
+                lDesc->NextIndex = LargeFrameDescriptor::NullIndex;
+
+                if (reclaimedTail == LargeFrameDescriptor::NullIndex)
+                    reclaimedHead = lIndex;
+                else
+                    this->Map[reclaimedTail].NextIndex = lIndex;
+
+                reclaimedTail = lIndex;
+            }
+        }
+
+    if (reclaimedHead != LargeFrameDescriptor::NullIndex)
+        withLock (this->LargeLocker)
+        {
+            this->Map[reclaimedTail].NextIndex = this->LargeFree;
+            this->LargeFree = reclaimedHead;
+        }
+}
+
+bool FrameAllocationSpace::FreeSmallFrame(uint32_t lIndex, LargeFrameDescriptor * lDesc, uint16_t sIndex, SmallFrameDescriptor * sDesc)
+{
+    //  Must be called under the split locker. Returns true if the large frame
+    //  ended up entirely free; it is unlinked from the split stack already.
+
+    sDesc->Free();
+
+    sDesc->NextIndex = lDesc->GetExtras()->NextFree;
+    lDesc->GetExtras()->NextFree = sIndex;
+    uint16_t subDescCnt = lDesc->GetExtras()->FreeCount += 1;
+
+    if unlikely(lDesc->Status == FrameStatus::Full)
+    {
+        //  Split frame used to be full, but not anymore. So it can
+        //  be added to the stack of non-full split frames.
+
+        lDesc->Status = FrameStatus::Split;
+
+        uint32_t next = this->SplitFree;
+
+        lDesc->NextIndex = next;
+        this->SplitFree = lIndex;
+
+        if likely(next != LargeFrameDescriptor::NullIndex)
+            this->Map[next].GetExtras()->PrevIndex = lIndex;
+
+        lDesc->GetExtras()->PrevIndex = LargeFrameDescriptor::NullIndex;
+    }
+    else if unlikely(subDescCnt == LargeFrameDescriptor::SubDescriptorsCount)
+    {
+        //  All small frames within the split frame are free, so it
+        //  can be freed completely.
+
+        uint32_t next = lDesc->NextIndex, prev = lDesc->GetExtras()->PrevIndex;
+
+        if (next != LargeFrameDescriptor::NullIndex)
+            this->Map[next].GetExtras()->PrevIndex = prev;
+        if (prev != LargeFrameDescriptor::NullIndex)
+            this->Map[prev].NextIndex = next;
+
+        if (this->SplitFree == lIndex)
+            this->SplitFree = next;
+
+        return true;
+    }
+
+    return false;
+}
+
+uint32_t FrameAllocationSpace::ClaimLargeRun(uint32_t count, uint32_t align)
+{
+    //  Must be called under the large locker. Runs are rare enough to warrant
+    //  a linear scan.
+
+    uint32_t const first = (uint32_t)((RoundUp(this->AllocationStart.Value, (uint64_t)align << 21)
+        - this->AllocationStart.Value) >> 21);
+    uint32_t base = first;
+
+    while (base + count <= this->LargeFrameCount)
+    {
+        uint32_t i = 0;
+
+        while (i < count && this->Map[base + i].Status == FrameStatus::Free)
+            ++i;
+
+        if (i < count)
+        {
+            base = first + (uint32_t)RoundUp(base + i + 1 - first, align);
+            //  No run can include the busy frame.
+
+            continue;
+        }
+
+        //  Found one! Now its large frames are taken off the free stack.
+
+        uint32_t * link = &(this->LargeFree);
+
+        while (*link != LargeFrameDescriptor::NullIndex)
+            if (*link - base < count)
+                *link = this->Map[*link].NextIndex;
+            else
+                link = &(this->Map[*link].NextIndex);
+
+        return base;
+    }
+
+    return LargeFrameDescriptor::NullIndex;
+}
+
+paddr_t FrameAllocationSpace::AllocateHugeFrame(uint32_t refCnt)
+{
+    //  A 1-GiB frame is made of consecutive free large frames, starting at a
+    //  1-GiB boundary.
+
+    withLock (this->LargeLocker)
+    {
+        uint32_t const base = this->ClaimLargeRun(LargeFrameDescriptor::HugeSpan, LargeFrameDescriptor::HugeSpan);
+
+        if (base == LargeFrameDescriptor::NullIndex)
+            return nullpaddr;
+
+        for (uint32_t i = 1; i < LargeFrameDescriptor::HugeSpan; ++i)
+            this->Map[base + i].Status = FrameStatus::Spanned;
+
+        this->Map[base].Use(refCnt);
+        this->Map[base].Status = FrameStatus::Huge;
+
+        return this->AllocationStart + psize_t((uint64_t)base << 21);
+    }
+
+    return nullpaddr;
+}
+
+paddr_t FrameAllocationSpace::AllocateContiguous(psize_t size, psize_t alignment, uint32_t refCnt)
+{
+    if (size > psize_t(LargePageSize.Value / 2) || alignment >= LargePageSize)
+    {
+        //  This is served by a run of large frames.
+
+        uint32_t const count = (uint32_t)(RoundUp(size.Value, LargePageSize.Value) >> 21);
+        uint32_t const align = (uint32_t)Maximum(alignment.Value >> 21, 1UL);
+
+        withLock (this->LargeLocker)
+        {
+            uint32_t const base = this->ClaimLargeRun(count, align);
+
+            if (base == LargeFrameDescriptor::NullIndex)
+                return nullpaddr;
+
+            for (uint32_t i = 0; i < count; ++i)
+                this->Map[base + i].Use(refCnt);
+
+            return this->AllocationStart + psize_t((uint64_t)base << 21);
+        }
+
+        return nullpaddr;
+    }
 
-                goto split_frame_full;
-            }
+    //  Smaller blocks are carved out of split frames. Their sizes are rounded
+    //  up to powers of two, and they are aligned to their size. The first small
+    //  frame of a split frame holds its descriptors, so a block can never start
+    //  there.
 
-            // MSG_("   Small frame index: %u2 (-> %u2)%n", sIndex, sDesc->NextIndex);
+    uint16_t const count = (uint16_t)(1U << FastCeilLog2<uint64_t>(RoundUp(size.Value, PageSize.Value) >> 12));
+    uint16_t const step = (uint16_t)Maximum((size_t)count, (size_t)(alignment.Value >> 12));
 
-            sDesc->Use(refCnt);
+    auto claim = [this, count, refCnt](uint32_t lIndex, uint16_t sIndex)
+    {
+        LargeFrameDescriptor * const lDesc = this->Map + lIndex;
+        SplitFrameExtra * const extra = lDesc->GetExtras();
 
-            lDesc->GetExtras()->NextFree = sDesc->NextIndex;
-            lDesc->GetExtras()->FreeCount -= 1;
+        uint16_t * link = &(extra->NextFree);
 
-            if unlikely(sDesc->NextIndex == SmallFrameDescriptor::NullIndex)
-            {
-                //  This was the last small frame in the split frame.
+        while (*link != SmallFrameDescriptor::NullIndex)
+            if ((uint16_t)(*link - sIndex) < count)
+                *link = lDesc->SubDescriptors[*link].NextIndex;
+            else
+                link = &(lDesc->SubDescriptors[*link].NextIndex);
 
-            split_frame_full:
-                lDesc->Status = FrameStatus::Full;
+        for (uint16_t i = 0; i < count; ++i)
+            lDesc->SubDescriptors[sIndex + i].Use(refCnt);
 
-                uint32_t next = lDesc->NextIndex;
-                this->SplitFree = next;
+        extra->FreeCount -= count;
 
-                if likely(next != LargeFrameDescriptor::NullIndex)
-                    this->Map[next].GetExtras()->PrevIndex = LargeFrameDescriptor::NullIndex;
-                //  No more previous frame for the next frame.
+        return this->AllocationStart + psize_t((uint64_t)lIndex << 21) + psize_t((uint64_t)sIndex << 12);
+    };
 
-                // MSG_("   Split frame depleted; Next: %u4%n", this->SplitFree);
+    withLock (this->SplitLocker)
+        for (uint32_t lIndex = this->SplitFree; lIndex != LargeFrameDescriptor::NullIndex; lIndex = this->Map[lIndex].NextIndex)
+        {
+            LargeFrameDescriptor * const lDesc = this->Map + lIndex;
+            SplitFrameExtra * const extra = lDesc->GetExtras();
 
-                onRelease if (sIndex == SmallFrameDescriptor::NullIndex)
-                    goto grab_large_page;
-                //  In release mode, this rather odd situation is tolerated.
-            }
-        }
+            if (extra->FreeCount < count)
+                continue;
 
-        // MSG_("   Returning address %XP **%n", this->AllocationStart + (lIndex << 21) + (sIndex << 12));
+            for (uint16_t sIndex = step; sIndex + count <= LargeFrameDescriptor::SubDescriptorsCount + 1; sIndex += step)
+            {
+                uint16_t i = 0;
 
-        return this->AllocationStart + psize_t(lIndex << 21) + psize_t(sIndex << 12);
-    }
+                while (i < count && lDesc->SubDescriptors[sIndex + i].Status == FrameStatus::Free)
+                    ++i;
 
-grab_large_page:
-    withLock (this->LargeLocker)
-    {
-        lIndex = this->LargeFree;
+                if (i < count)
+                    continue;
 
-        if (lIndex == LargeFrameDescriptor::NullIndex)
-            return nullpaddr;
+                paddr_t const ret = claim(lIndex, sIndex);
 
-        //  Reaching this point means a non-full split frame exists!
+                if (extra->FreeCount == 0)
+                {
+                    //  The split frame is now full, so it leaves the stack.
 
-        lDesc = this->Map + lIndex;
+                    lDesc->Status = FrameStatus::Full;
 
-        this->LargeFree = lDesc->NextIndex;
-        paddr = this->AllocationStart + psize_t(lIndex << 21);
+                    uint32_t const next = lDesc->NextIndex, prev = extra->PrevIndex;
 
-        if (size == FrameSize::_2MiB)
-        {
-            lDesc->Use(refCnt);
+                    if (next != LargeFrameDescriptor::NullIndex)
+                        this->Map[next].GetExtras()->PrevIndex = prev;
+                    if (prev != LargeFrameDescriptor::NullIndex)
+                        this->Map[prev].NextIndex = next;
 
-            return paddr;
+                    if (this->SplitFree == lIndex)
+                        this->SplitFree = next;
+                }
+
+                return ret;
+            }
         }
-    }
 
-    //  At this point, `lIndex`, `paddr` and `lDesc` are valid.
+    //  No split frame has room, so a fresh large frame is split.
 
-    SplitLargeFrame(lDesc);
+    uint32_t lIndex = LargeFrameDescriptor::NullIndex;
 
-    sIndex = lDesc->GetExtras()->NextFree;
-    SmallFrameDescriptor * const sDesc = lDesc->SubDescriptors + sIndex;
+    withLock (this->LargeLocker)
+        if likely((lIndex = this->LargeFree) != LargeFrameDescriptor::NullIndex)
+            this->LargeFree = this->Map[lIndex].NextIndex;
 
-    sDesc->Use(refCnt);
+    if unlikely(lIndex == LargeFrameDescriptor::NullIndex)
+        return nullpaddr;
 
-    lDesc->GetExtras()->NextFree = sDesc->NextIndex;
-    lDesc->GetExtras()->FreeCount -= 1;
+    LargeFrameDescriptor * const lDesc = this->Map + lIndex;
+
+    SplitLargeFrame(lDesc);
+
+    paddr_t const ret = claim(lIndex, step);
+    //  A block this small always leaves some room.
 
     withLock (this->SplitLocker)
     {
-        //  Gotta put this frame on top of the stack.
-
         uint32_t next = this->SplitFree;
 
         lDesc->NextIndex = next;
@@ -470,7 +1464,33 @@ grab_large_page:
             this->Map[next].GetExtras()->PrevIndex = lIndex;
     }
 
-    return this->AllocationStart + psize_t(lIndex << 21) + psize_t(sIndex << 12);
+    return ret;
+}
+
+uint32_t FrameAllocationSpace::GetHugeFrameHead(uint32_t lIndex) const
+{
+    //  Huge frames are claimed at physical 1-GiB boundaries, which is where
+    //  their runs of spanned large frames start.
+
+    uint32_t const first = (uint32_t)((RoundUp(this->AllocationStart.Value, (uint64_t)LargeFrameDescriptor::HugeSpan << 21)
+        - this->AllocationStart.Value) >> 21);
+
+    return lIndex - (lIndex - first) % LargeFrameDescriptor::HugeSpan;
+}
+
+void FrameAllocationSpace::FreeHugeFrame(uint32_t lIndex)
+{
+    //  Must be called under the large locker.
+
+    for (uint32_t i = lIndex + LargeFrameDescriptor::HugeSpan; i-- > lIndex; )
+    {
+        LargeFrameDescriptor * const lDesc = this->Map + i;
+
+        lDesc->Free();
+
+        lDesc->NextIndex = this->LargeFree;
+        this->LargeFree = i;
+    }
 }
 
 Handle FrameAllocationSpace::Mingle(paddr_t addr, uint32_t & newCnt, int32_t diff, bool ignoreRefCnt)
@@ -481,6 +1501,11 @@ Handle FrameAllocationSpace::Mingle(paddr_t addr, uint32_t & newCnt, int32_t dif
 
     uint32_t lIndex = (uint32_t)((addr - this->AllocationStart).Value >> 21UL);
     LargeFrameDescriptor * lDesc = this->Map + lIndex;
+
+    if (lDesc->Status == FrameStatus::Spanned)
+        lDesc = this->Map + (lIndex = this->GetHugeFrameHead(lIndex));
+    //  Parts of a huge frame are counted on it, once it is split into large pages.
+
     uint16_t sIndex = (uint16_t)((addr.Value & 0x1FF000) >> 12);
     SmallFrameDescriptor * sDesc = lDesc->SubDescriptors + sIndex;
 
@@ -503,6 +1528,7 @@ Handle FrameAllocationSpace::Mingle(paddr_t addr, uint32_t & newCnt, int32_t dif
         return HandleResult::PageFree;
 
     case FrameStatus::Used:
+    case FrameStatus::Huge:
         break;
         //  Will move onto the next phase, which is under a lock.
 
@@ -511,6 +1537,7 @@ Handle FrameAllocationSpace::Mingle(paddr_t addr, uint32_t & newCnt, int32_t dif
         goto do_small_frame;
 
     case FrameStatus::Reserved:
+    case FrameStatus::Spanned:
         return HandleResult::PageReserved;
 
     default:
@@ -551,12 +1578,23 @@ do_large_frame:
             //  No? Bad.
             return diff == 0 ? HandleResult::PageInUse : HandleResult::Okay;
 
+        case FrameStatus::Huge:
+            if likely(test(lDesc))
+            {
+                this->FreeHugeFrame(lIndex);
+
+                return HandleResult::Okay;
+            }
+
+            return diff == 0 ? HandleResult::PageInUse : HandleResult::Okay;
+
         case FrameStatus::Split:
         case FrameStatus::Full:
             break;
             //  Simply leave the switch statement and continue execution.
 
         case FrameStatus::Reserved:
+        case FrameStatus::Spanned:
             return HandleResult::PageReserved;
 
         default:
@@ -584,6 +1622,7 @@ do_small_frame:
             return HandleResult::PageFree;
 
         case FrameStatus::Used:
+        case FrameStatus::Huge:
             goto do_large_frame;
 
         case FrameStatus::Split:
@@ -592,6 +1631,7 @@ do_small_frame:
             //  Simply leave the switch statement and continue execution.
 
         case FrameStatus::Reserved:
+        case FrameStatus::Spanned:
             return HandleResult::PageReserved;
 
         default:
@@ -617,46 +1657,8 @@ do_small_frame:
         case FrameStatus::Used:
             if likely(test(sDesc))
             {
-                sDesc->Free();
-
-                sDesc->NextIndex = lDesc->GetExtras()->NextFree;
-                lDesc->GetExtras()->NextFree = sIndex;
-                uint16_t subDescCnt = lDesc->GetExtras()->FreeCount += 1;
-
-                if unlikely(lDesc->Status == FrameStatus::Full)
-                {
-                    //  Split frame used to be full, but not anymore. So it can
-                    //  be added to the stack of non-full split frames.
-
-                    lDesc->Status = FrameStatus::Split;
-
-                    uint32_t next = this->SplitFree;
-
-                    lDesc->NextIndex = next;
-                    this->SplitFree = lIndex;
-
-                    if likely(next != LargeFrameDescriptor::NullIndex)
-                        this->Map[next].GetExtras()->PrevIndex = lIndex;
-
-                    lDesc->GetExtras()->PrevIndex = LargeFrameDescriptor::NullIndex;
-                }
-                else if unlikely(subDescCnt == LargeFrameDescriptor::SubDescriptorsCount)
-                {
-                    //  All small frames within the split frame are free, so it
-                    //  can be freed completely.
-
-                    uint32_t next = lDesc->NextIndex, prev = lDesc->GetExtras()->PrevIndex;
-
-                    if (next != LargeFrameDescriptor::NullIndex)
-                        this->Map[next].GetExtras()->PrevIndex = prev;
-                    if (prev != LargeFrameDescriptor::NullIndex)
-                        this->Map[prev].NextIndex = next;
-
-                    if (this->SplitFree == lIndex)
-                        this->SplitFree = next;
-
+                if unlikely(this->FreeSmallFrame(lIndex, lDesc, sIndex, sDesc))
                     goto reclaim_large_frame;
-                }
 
                 return HandleResult::Okay;
             }
@@ -700,6 +1702,94 @@ reclaim_large_frame:
     return HandleResult::Okay;
 }
 
+Handle FrameAllocationSpace::Detach(paddr_t addr, uint32_t & newCnt, int32_t diff, bool ignoreRefCnt, FrameSize & size)
+{
+    //  This is `Mingle` without any locks. A frame which would be freed is left
+    //  in use, without references, for the caller to recycle; `newCnt` is zero
+    //  exactly in that case. The caller must hold a reference to the frame, so
+    //  neither its status nor that of its large frame can change meanwhile.
+
+    if (addr < this->AllocationStart || addr >= this->AllocationEnd)
+        return HandleResult::PagesOutOfAllocatorRange;
+
+    uint32_t lIndex = (uint32_t)((addr - this->AllocationStart).Value >> 21UL);
+    LargeFrameDescriptor * lDesc = this->Map + lIndex;
+
+    if (lDesc->Status == FrameStatus::Spanned)
+        lDesc = this->Map + (lIndex = this->GetHugeFrameHead(lIndex));
+    //  Parts of a huge frame are counted on it.
+
+    uint16_t sIndex = (uint16_t)((addr.Value & 0x1FF000) >> 12);
+    FrameDescriptor * desc;
+
+    switch (lDesc->Status)
+    {
+    case FrameStatus::Free:
+        return HandleResult::PageFree;
+
+    case FrameStatus::Used:
+        desc = lDesc;
+        size = FrameSize::_2MiB;
+        break;
+
+    case FrameStatus::Huge:
+        desc = lDesc;
+        size = FrameSize::_1GiB;
+        break;
+
+    case FrameStatus::Split:
+    case FrameStatus::Full:
+        if unlikely(sIndex == 0)
+            return HandleResult::PageReserved;
+
+        desc = lDesc->SubDescriptors + sIndex;
+        size = FrameSize::_4KiB;
+        break;
+
+    case FrameStatus::Reserved:
+    case FrameStatus::Spanned:
+        return HandleResult::PageReserved;
+
+    default:
+        assert_or(false
+            , "Unknown status for large frame @%XP: %u2"
+            , addr, lDesc->Status)
+        {
+            return HandleResult::IntegrityFailure;
+        }
+    }
+
+    switch (desc->Status)
+    {
+    case FrameStatus::Free:
+        return HandleResult::PageFree;
+
+    case FrameStatus::Used:
+    case FrameStatus::Huge:
+        break;
+
+    case FrameStatus::Reserved:
+        return HandleResult::PageReserved;
+
+    default:
+        assert_or(false
+            , "Invalid status for frame @%XP: %u2."
+            , addr, desc->Status)
+        {
+            return HandleResult::IntegrityFailure;
+        }
+    }
+
+    if (diff != 0)
+        newCnt = desc->AdjustReferenceCount(diff);
+    else if likely(ignoreRefCnt || desc->ReferenceCount <= 1)
+        newCnt = desc->ResetReferenceCount();
+    else
+        return HandleResult::PageInUse;
+
+    return HandleResult::Okay;
+}
+
 Handle FrameAllocationSpace::ReserveRange(paddr_t start, psize_t size, bool includeBusy)
 {
     if (start < this->AllocationStart || (start + size) >= this->AllocationEnd)
@@ -716,6 +1806,11 @@ Handle FrameAllocationSpace::GetFrameInfo(paddr_t addr, FrameSize & size, uint32
 
     uint32_t lIndex = (uint32_t)((addr - this->AllocationStart).Value >> 21UL);
     LargeFrameDescriptor * lDesc = this->Map + lIndex;
+
+    if (lDesc->Status == FrameStatus::Spanned)
+        lDesc = this->Map + (lIndex = this->GetHugeFrameHead(lIndex));
+    //  Parts of a huge frame report on it.
+
     uint16_t sIndex = (uint16_t)((addr.Value & 0x1FF000) >> 12);
     SmallFrameDescriptor * sDesc = lDesc->SubDescriptors + sIndex;
 
@@ -731,6 +1826,7 @@ Handle FrameAllocationSpace::GetFrameInfo(paddr_t addr, FrameSize & size, uint32
         return HandleResult::PageFree;
 
     case FrameStatus::Used:
+    case FrameStatus::Huge:
         break;
         //  Will move onto the next phase, which is under a lock.
 
@@ -739,6 +1835,7 @@ Handle FrameAllocationSpace::GetFrameInfo(paddr_t addr, FrameSize & size, uint32
         goto do_small_frame;
 
     case FrameStatus::Reserved:
+    case FrameStatus::Spanned:
         size = FrameSize::_2MiB;
         refCnt = lDesc->ReferenceCount;
 
@@ -776,12 +1873,19 @@ do_large_frame:
 
             return HandleResult::PageInUse;
 
+        case FrameStatus::Huge:
+            size = FrameSize::_1GiB;
+            refCnt = lDesc->ReferenceCount;
+
+            return HandleResult::PageInUse;
+
         case FrameStatus::Split:
         case FrameStatus::Full:
             break;
             //  Simply leave the switch statement and continue execution.
 
         case FrameStatus::Reserved:
+        case FrameStatus::Spanned:
             size = FrameSize::_2MiB;
             refCnt = lDesc->ReferenceCount;
 
@@ -815,6 +1919,7 @@ do_small_frame:
             return HandleResult::PageFree;
 
         case FrameStatus::Used:
+        case FrameStatus::Huge:
             goto do_large_frame;
 
         case FrameStatus::Split:
@@ -823,6 +1928,7 @@ do_small_frame:
             //  Simply leave the switch statement and continue execution.
 
         case FrameStatus::Reserved:
+        case FrameStatus::Spanned:
             size = FrameSize::_2MiB;
             refCnt = lDesc->ReferenceCount;
 
@@ -888,57 +1994,113 @@ do_small_frame:
 
 /*  Page Manipulation  */
 
-paddr_t FrameAllocator::AllocateFrame(FrameSize size, AddressMagnitude magn, uint32_t refCnt)
+paddr_t FrameAllocator::AllocateFrame(FrameSize size, AddressMagnitude magn, uint32_t refCnt, NumaNode node)
 {
+    if unlikely(magn == AddressMagnitude::_24bit || magn == AddressMagnitude::_16bit)
+    {
+        //  TODO: 24-bit and 16-bit addresses, maybeh?
+
+        FAIL("Unable to serve frames of address magnitude %s."
+            , (magn == AddressMagnitude::_24bit) ? "24-bit" : "16-bit");
+
+        return nullpaddr;
+    }
+
     paddr_t ret = nullpaddr;
-    FrameAllocationSpace * space;
 
-    if (magn == AddressMagnitude::Any || magn == AddressMagnitude::_48bit)
+    VisitSpaces(this, magn, node, [size, refCnt, &ret](FrameAllocationSpace * space)
     {
-        //  Any space is alright.
+        ret = space->AllocateFrame(size, refCnt);
 
-        space = this->LastSpace;
+        return ret != nullpaddr;
+    });
 
-        while (space != nullptr)
-        {
-            ret = space->AllocateFrame(size, refCnt);
+    return ret;
+}
 
-            if (ret != nullpaddr)
-                return ret;
+size_t FrameAllocator::AllocateFrames(FrameSize size, AddressMagnitude magn, paddr_t * addrs, size_t count, uint32_t refCnt, NumaNode node)
+{
+    if unlikely(magn == AddressMagnitude::_24bit || magn == AddressMagnitude::_16bit)
+    {
+        FAIL("Unable to serve frames of address magnitude %s."
+            , (magn == AddressMagnitude::_24bit) ? "24-bit" : "16-bit");
 
-            space = space->Previous;
-        }
+        return 0;
     }
-    else if (magn == AddressMagnitude::_32bit)
+
+    size_t done = 0;
+
+    VisitSpaces(this, magn, node, [size, addrs, count, refCnt, &done](FrameAllocationSpace * space)
     {
-        space = this->LastSpace;
+        done += space->AllocateFrames(size, addrs + done, count - done, refCnt);
 
-        while (space != nullptr)
-        {
-            if (space->GetAllocationEnd() <= (1ULL << 32))
-            {
-                //  The condition checks that the allocation space ends
-                //  at a 32-bit address. (all the other addresses are less,
-                //  thus have to be 32-bit if the end is)
+        return done == count;
+    });
 
-                ret = space->AllocateFrame(size, refCnt);
+    return done;
+}
 
-                if (ret != nullpaddr)
-                    return ret;
-            }
+paddr_t FrameAllocator::AllocateContiguous(psize_t size, psize_t alignment, AddressMagnitude magn, uint32_t refCnt, NumaNode node)
+{
+    if unlikely(magn == AddressMagnitude::_24bit || magn == AddressMagnitude::_16bit)
+    {
+        FAIL("Unable to serve frames of address magnitude %s."
+            , (magn == AddressMagnitude::_24bit) ? "24-bit" : "16-bit");
 
-            space = space->Previous;
-        }
+        return nullpaddr;
     }
-    else
+
+    paddr_t ret = nullpaddr;
+
+    VisitSpaces(this, magn, node, [size, alignment, refCnt, &ret](FrameAllocationSpace * space)
     {
-        //  TODO: 24-bit and 16-bit addresses, maybeh?
+        ret = space->AllocateContiguous(size, alignment, refCnt);
 
-        FAIL("Unable to serve frames of address magnitude %s."
-            , (magn == AddressMagnitude::_24bit) ? "24-bit" : "16-bit");
+        return ret != nullpaddr;
+    });
+
+    return ret;
+}
+
+void FrameAllocator::FreeFrames(FrameSize size, paddr_t const * addrs, size_t count)
+{
+    while (count > 0)
+    {
+        FrameAllocationSpace * const space = this->GetSpace(addrs[0]);
+
+        ASSERT(space != nullptr
+            , "Frame @%XP is outside of all allocation spaces."
+            , addrs[0]);
+
+        size_t run = 1;
+
+        while (run < count && space->ContainsRange(addrs[run], psize_t(1)))
+            ++run;
+        //  Consecutive frames from the same space are freed together.
+
+        space->FreeFrames(size, addrs, run);
+
+        addrs += run;
+        count -= run;
     }
+}
 
-    return nullpaddr;
+Handle FrameAllocator::Detach(paddr_t addr, uint32_t & newCnt, int32_t diff, bool ignoreRefCnt, FrameSize & size)
+{
+    Handle res;
+    FrameAllocationSpace * space = this->FirstSpace;
+
+    while (space != nullptr)
+    {
+        res = space->Detach(addr, newCnt, diff, ignoreRefCnt, size);
+
+        if (res != HandleResult::PagesOutOfAllocatorRange)
+            return res;
+
+        space = space->Next;
+    }
+
+    return HandleResult::PagesOutOfAllocatorRange;
 }
 
 Handle FrameAllocator::Mingle(paddr_t addr, uint32_t & newCnt, int32_t diff, bool ignoreRefCnt)
@@ -67,6 +67,14 @@ static __forceinline bool Is4KiBAligned(TInt val) { return (val.Value & (     Pa
 template<typename TInt>
 static __forceinline bool Is2MiBAligned(TInt val) { return (val.Value & (LargePageSize.Value - 1)) == 0; }
 
+template<typename TInt>
+static __forceinline bool Is1GiBAligned(TInt val) { return (val.Value & ( HugePageSize.Value - 1)) == 0; }
+
+static __forceinline FrameSize GetLevelFrameSize(int level)
+{
+    return level == 1 ? FrameSize::_4KiB : (level == 2 ? FrameSize::_2MiB : FrameSize::_1GiB);
+}
+
 /****************
     Vmm class
 ****************/
@@ -111,6 +119,53 @@ inline void Alienate(Process * proc)
     pml4[VmmArc::AlienFractalIndex] = Pml4Entry(proc->PagingTable, true, true, false, VmmArc::NX);
 }
 
+/*  Process-Context Identifiers  */
+
+static size_t const PcidSlotCount = 64;
+static __thread uint64_t PcidSlots[PcidSlotCount];
+//  TLB generation each core last loaded for a tag, hashed.
+
+static Atomic<size_t> PcidCounter {0};
+static Atomic<uint64_t> TlbGenerationCounter {0};
+
+/**
+ *  <summary>
+ *  Determines whether the given address is shared by all processes, and thus
+ *  mapped as global when PCIDs are in use.
+ *  </summary>
+ */
+static __forceinline bool IsShared(vaddr_t const vaddr)
+{
+    return vaddr >= VmmArc::HigherHalfStart
+        && (vaddr < VmmArc::AlienPml1Base || vaddr >= VmmArc::LocalPml1Base + (1ULL << 39));
+    //  Everything but the fractal mappings.
+}
+
+/**
+ *  <summary>
+ *  Makes every core reload the process' tag with a flush, except for those on
+ *  which it is active and which receive the shootdown.
+ *  </summary>
+ */
+static __hot void ExpireTags(Process * proc, vaddr_t const vaddr)
+{
+    if (VmmArc::PCID && !IsShared(vaddr))
+        proc->TlbGeneration.Store(++TlbGenerationCounter);
+}
+
+/**
+ *  <summary>
+ *  Forgets all the tags loaded on the current core, whose paging-structure
+ *  caches may refer to shared tables that changed.
+ *  </summary>
+ */
+static __hot void ForgetTags(vaddr_t const vaddr)
+{
+    if (VmmArc::PCID && IsShared(vaddr) && CpuDataSetUp)
+        for (size_t i = 0; i < PcidSlotCount; ++i)
+            PcidSlots[i] = 0;
+}
+
 /*  Statics  */
 
 vaddr_t Vmm::UserlandStart { 1ULL << 21 };    //  2 MiB
@@ -160,6 +215,9 @@ Handle Vmm::Bootstrap(Process * const bootstrapProc)
     //  Very important note: the user-accessible bit is cleared.
     //  This means userland code will not be able to look at the fractal mapping.
 
+    bootstrapProc->TlbGeneration.Store(++TlbGenerationCounter);
+    //  Its tag is 0.
+
     Vmm::Switch(nullptr, bootstrapProc);
     //  Activate, so pages can be mapped.
 
@@ -316,6 +374,11 @@ Handle Vmm::Initialize(Process * proc)
         return HandleResult::OutOfMemory;
     //  Do the good deed.
 
+    proc->Pcid = (uint16_t)(1 + PcidCounter++ % Cr3::PcidBits);
+    proc->TlbGeneration.Store(++TlbGenerationCounter);
+    //  Tags are handed out round-robin and may be shared; a fresh generation
+    //  makes sure no core trusts entries left behind by a previous owner.
+
     SmpLock * alienLock = nullptr;
 
     InterruptGuard<> intGuard;
@@ -359,9 +422,41 @@ Handle Vmm::Initialize(Process * proc)
 
 Handle Vmm::Switch(Process * const oldProc, Process * const newProc)
 {
-    (void)oldProc;
+    if (!VmmArc::PCID)
+    {
+        Cpu::SetCr3(Cr3(newProc->PagingTable, false, false));
+
+        return HandleResult::Okay;
+    }
+
+    Cr3 newVal = Cr3(newProc->PagingTable, false, false);
+    newVal.SetPcid(newProc->Pcid);
+
+    InterruptGuard<> intGuard;
+
+    if (oldProc == nullptr)
+    {
+        //  First switch on this core, possibly before its data is set up.
+
+        Cr4 cr4 = Cpu::GetCr4();
+
+        if (!cr4.GetPcide())
+            Cpu::SetCr4(cr4.SetPcide(true));
+        //  CR3 carries no tag at this point, as required.
+    }
+    else
+    {
+        uint64_t & slot = PcidSlots[newProc->Pcid % PcidSlotCount];
+        uint64_t const gen = newProc->TlbGeneration.Load();
+
+        newVal.SetNoFlush(slot == gen);
+        slot = gen;
+        //  Entries are kept only if nothing was invalidated since this core
+        //  last loaded the tag for this very process.
 
-    Cr3 const newVal = Cr3(newProc->PagingTable, false, false);
+        VmmArc::LastAlienPml4 = nullpaddr;
+        //  The alien mapping cached under the new tag may be another one.
+    }
 
     Cpu::SetCr3(newVal);
 
@@ -384,78 +479,313 @@ bool Vmm::IsAlien(Process * proc)
 
 /*  Page Management  */
 
-template<typename cbk_t>
-static __hot __noinline Handle TranslateInternal(Process * proc
-    , vaddr_t const vaddr
-    , cbk_t cbk
-    , bool const lockHeap
-    , bool const lockAlien
-    , bool const nonLocal)
+/**
+ *  <summary>
+ *  A cursor over the paging tables of a process, reached through either
+ *  fractal mapping. It remembers which tables were found present for the last
+ *  addresses, so consecutive pages only descend again at table boundaries.
+ *  The caller must hold the locks over the tables for its whole lifetime.
+ *  </summary>
+ */
+class PageWalker
 {
-    Pml4 * pml4p; Pml3 * pml3p; Pml2 * pml2p; Pml1 * pml1p;
+    static constexpr uint64_t const NoSpan = ~0ULL;
 
-    SmpLock * alienLock = nullptr, * heapLock = nullptr;
+public:
+    /*  Constructors  */
 
-    if (lockAlien && nonLocal && CpuDataSetUp)
-        alienLock = &(Cpu::GetProcess()->AlienPagingTablesLock);
+    inline PageWalker(Process * const proc, bool const nonLocal)
+        : NonLocal( nonLocal)
+        , Pml3Span(NoSpan)
+        , Pml2Span(NoSpan)
+        , Pml1Span(NoSpan)
+        , HoleEnd(nullvaddr)
+    {
+        if (nonLocal)
+        {
+            Alienate(proc);
 
-    LockGuardFlexible<SmpLock > pml4Lg {alienLock};
+            if (!CpuDataSetUp || proc->PagingTable != VmmArc::LastAlienPml4)
+            {
+                Cpu::SetCr3(Cpu::GetCr3());
+                //  Invalidate all! Any table of the previous alien may be
+                //  cached, and the walk may cover many of them.
+
+                if (CpuDataSetUp)
+                    VmmArc::LastAlienPml4 = proc->PagingTable;
+            }
+        }
+    }
+
+    /*  Tables  */
 
-    if (nonLocal)
+    __forceinline Pml4 * GetPml4() const
     {
-        Alienate(proc);
+        return this->NonLocal ? VmmArc::GetAlienPml4() : VmmArc::GetLocalPml4();
+    }
+
+    __forceinline Pml3 * GetPml3(vaddr_t const vaddr) const
+    {
+        return this->NonLocal ? VmmArc::GetAlienPml3(vaddr) : VmmArc::GetLocalPml3(vaddr);
+    }
+
+    __forceinline Pml2 * GetPml2(vaddr_t const vaddr) const
+    {
+        return this->NonLocal ? VmmArc::GetAlienPml2(vaddr) : VmmArc::GetLocalPml2(vaddr);
+    }
+
+    __forceinline Pml1 * GetPml1(vaddr_t const vaddr) const
+    {
+        return this->NonLocal ? VmmArc::GetAlienPml1(vaddr) : VmmArc::GetLocalPml1(vaddr);
+    }
+
+    /*  Operations  */
+
+    /**
+     *  <summary>
+     *  Makes sure the table of the given level which covers the given address
+     *  is present, optionally allocating the missing ones on the way.
+     *  </summary>
+     *  <return>PageUnmapped if a table is missing; PageMapped if a larger page covers the address.</return>
+     */
+    __hot Handle Reach(vaddr_t const vaddr, int const level, bool const create)
+    {
+        if (this->Pml3Span != vaddr.Value >> 39)
+        {
+            Pml4Entry & e = this->GetPml4()->operator[](VmmArc::GetPml4Index(vaddr));
+
+            if unlikely(!e.GetPresent())
+            {
+                if (!create)
+                    return this->Hole(vaddr, 39);
+
+                paddr_t const newPml3 = Pmm::AllocateFrame(1);
+
+                if (newPml3 == nullpaddr)
+                    return HandleResult::OutOfMemory;
+
+                e = Pml4Entry(newPml3, true, true, true, false);
+                //  Present, writable, user-accessible, executable.
+
+                memset(this->GetPml3(vaddr), 0, PageSize);
+            }
+
+            this->Pml3Span = vaddr.Value >> 39;
+        }
+
+        if (level == 3)
+            return HandleResult::Okay;
 
-        pml4p = VmmArc::GetAlienPml4();
-        pml3p = VmmArc::GetAlienPml3(vaddr);
-        pml2p = VmmArc::GetAlienPml2(vaddr);
-        pml1p = VmmArc::GetAlienPml1(vaddr);
+        if (this->Pml2Span != vaddr.Value >> 30)
+        {
+            Pml3Entry & e = this->GetPml3(vaddr)->operator[](VmmArc::GetPml3Index(vaddr));
+
+            if unlikely(!e.GetPresent())
+            {
+                if (!create)
+                    return this->Hole(vaddr, 30);
+
+                paddr_t const newPml2 = Pmm::AllocateFrame(1);
+
+                if (newPml2 == nullpaddr)
+                    return HandleResult::OutOfMemory;
+
+                e = Pml3Entry(newPml2, true, true, true, false);
+                //  First clean, then assign an entry.
+
+                memset(this->GetPml2(vaddr), 0, PageSize);
+            }
+            else if unlikely(e.GetPageSize())
+                return HandleResult::PageMapped;
+            //  A 1-GiB page covers this address.
 
-        if (!CpuDataSetUp || proc->PagingTable != VmmArc::LastAlienPml4)
+            this->Pml2Span = vaddr.Value >> 30;
+        }
+
+        if (level == 2)
+            return HandleResult::Okay;
+
+        if (this->Pml1Span != vaddr.Value >> 21)
         {
-            CpuInstructions::InvalidateTlb(pml4p);
-            CpuInstructions::InvalidateTlb(pml3p);
-            CpuInstructions::InvalidateTlb(pml2p);
-            CpuInstructions::InvalidateTlb(pml1p);
+            Pml2Entry & e = this->GetPml2(vaddr)->operator[](VmmArc::GetPml2Index(vaddr));
+
+            if unlikely(!e.GetPresent())
+            {
+                if (!create)
+                    return this->Hole(vaddr, 21);
+
+                paddr_t const newPml1 = Pmm::AllocateFrame(1);
+
+                if (newPml1 == nullpaddr)
+                    return HandleResult::OutOfMemory;
 
-            //  Invalidate all!
+                e = Pml2Entry(newPml1, true, true, true, false);
+                //  Present, writable, user-accessible, executable.
 
-            if (CpuDataSetUp)
-                VmmArc::LastAlienPml4 = proc->PagingTable;
+                memset(this->GetPml1(vaddr), 0, PageSize);
+            }
+            else if unlikely(e.GetPageSize())
+                return HandleResult::PageMapped;
+            //  A 2-MiB page covers this address.
+
+            this->Pml1Span = vaddr.Value >> 21;
         }
+
+        return HandleResult::Okay;
     }
-    else
+
+    /**
+     *  <summary>Maps a page of the given size at the given address.</summary>
+     *  <return>PageMapped if the address is already covered.</return>
+     */
+    __hot Handle Map(vaddr_t const vaddr, paddr_t const paddr
+        , FrameSize const size, MemoryFlags const flags)
     {
-        pml4p = VmmArc::GetLocalPml4();
-        pml3p = VmmArc::GetLocalPml3(vaddr);
-        pml2p = VmmArc::GetLocalPml2(vaddr);
-        pml1p = VmmArc::GetLocalPml1(vaddr);
+        bool const global = 0 != (flags & MemoryFlags::Global) || (VmmArc::PCID && IsShared(vaddr));
+        //  Shared mappings must be global so invalidating them reaches all tags.
+
+        bool const writable = 0 != (flags & MemoryFlags::Writable);
+        bool const userland = 0 != (flags & MemoryFlags::Userland);
+        bool const xd = 0 == (flags & MemoryFlags::Executable) && VmmArc::NX;
+
+        int const level = size == FrameSize::_4KiB ? 1 : (size == FrameSize::_2MiB ? 2 : 3);
+
+        Handle res = this->Reach(vaddr, level, true);
+
+        if unlikely(res != HandleResult::Okay)
+            return res;
+
+        if (level == 1)
+        {
+            Pml1Entry & e = this->GetPml1(vaddr)->operator[](VmmArc::GetPml1Index(vaddr));
+
+            if unlikely(e.GetPresent())
+                return HandleResult::PageMapped;
+
+            e = Pml1Entry(paddr, true, writable, userland, global, xd);
+        }
+        else if (level == 2)
+        {
+            Pml2Entry & e = this->GetPml2(vaddr)->operator[](VmmArc::GetPml2Index(vaddr));
+
+            if unlikely(e.GetPresent())
+                return HandleResult::PageMapped;
+
+            e = Pml2Entry(paddr, true, writable, userland, global, xd);
+        }
+        else
+        {
+            Pml3Entry & e = this->GetPml3(vaddr)->operator[](VmmArc::GetPml3Index(vaddr));
+
+            if unlikely(e.GetPresent())
+                return HandleResult::PageMapped;
+
+            e = Pml3Entry(paddr, true, writable, userland, global, xd);
+        }
+        //  Present, writable, user-accessible, global, executable.
+
+        return HandleResult::Okay;
     }
 
-    if (lockHeap)
-        heapLock = vaddr < VmmArc::LowerHalfEnd ? &proc->LocalTablesLock : &Vmm::KernelHeapLock;
+    /**
+     *  <summary>Finds the entry which maps the given address.</summary>
+     *  <return>PageUnmapped if there is none.</return>
+     */
+    __hot Handle Find(vaddr_t const vaddr, PmlCommonEntry * & entry, int & level)
+    {
+        Handle res = this->Reach(vaddr, 1, false);
 
-    LockGuardFlexible<SmpLock > heapLg {heapLock};
+        if likely(res == HandleResult::Okay)
+        {
+            Pml1Entry & e = this->GetPml1(vaddr)->operator[](VmmArc::GetPml1Index(vaddr));
 
-    if unlikely(!pml4p->operator[](VmmArc::GetPml4Index(vaddr)).GetPresent())
-        return HandleResult::PageUnmapped;
+            if unlikely(!e.GetPresent())
+                return this->Hole(vaddr, 12);
 
-    if unlikely(!pml3p->operator[](VmmArc::GetPml3Index(vaddr)).GetPresent())
-        return HandleResult::PageUnmapped;
+            entry = reinterpret_cast<PmlCommonEntry *>(&e);
+            level = 1;
+        }
+        else if (res == HandleResult::PageMapped)
+        {
+            Pml3Entry & e3 = this->GetPml3(vaddr)->operator[](VmmArc::GetPml3Index(vaddr));
 
-    Pml2Entry & pml2e = pml2p->operator[](VmmArc::GetPml2Index(vaddr));
+            if (e3.GetPageSize())
+            {
+                entry = reinterpret_cast<PmlCommonEntry *>(&e3);
+                level = 3;
+            }
+            else
+            {
+                entry = reinterpret_cast<PmlCommonEntry *>(&(this->GetPml2(vaddr)->operator[](VmmArc::GetPml2Index(vaddr))));
+                level = 2;
+            }
+        }
+        else
+            return res;
 
-    if unlikely(!pml2e.GetPresent())
-        return HandleResult::PageUnmapped;
+        return HandleResult::Okay;
+    }
+
+    /**
+     *  <summary>
+     *  Gets the end of the unmapped span which contains the address that was
+     *  last reported as unmapped, or null if it reaches the end of memory.
+     *  </summary>
+     */
+    __forceinline vaddr_t GetHoleEnd() const
+    {
+        return this->HoleEnd;
+    }
 
-    if (pml2e.GetPageSize())
-        return cbk(reinterpret_cast<PmlCommonEntry *>(&pml2e), 2);
+private:
+    /*  Utilities  */
 
-    Pml1Entry & pml1e = pml1p->operator[](VmmArc::GetPml1Index(vaddr));
+    __forceinline Handle Hole(vaddr_t const vaddr, unsigned int const shift)
+    {
+        this->HoleEnd = vaddr_t(((vaddr.Value >> shift) + 1) << shift);
 
-    if unlikely(!pml1e.GetPresent())
         return HandleResult::PageUnmapped;
+    }
+
+    /*  Fields  */
+
+    bool const NonLocal;
+    uint64_t Pml3Span, Pml2Span, Pml1Span;
+    //  Address spans whose tables of each level are known to be present.
+    vaddr_t HoleEnd;
+};
+
+template<typename cbk_t>
+static __hot __noinline Handle TranslateInternal(Process * proc
+    , vaddr_t const vaddr
+    , cbk_t cbk
+    , bool const lockHeap
+    , bool const lockAlien
+    , bool const nonLocal)
+{
+    SmpLock * alienLock = nullptr, * heapLock = nullptr;
+
+    if (lockAlien && nonLocal && CpuDataSetUp)
+        alienLock = &(Cpu::GetProcess()->AlienPagingTablesLock);
+
+    LockGuardFlexible<SmpLock > pml4Lg {alienLock};
+
+    PageWalker walker {proc, nonLocal};
+
+    if (lockHeap)
+        heapLock = vaddr < VmmArc::LowerHalfEnd ? &proc->LocalTablesLock : &Vmm::KernelHeapLock;
+
+    LockGuardFlexible<SmpLock > heapLg {heapLock};
+
+    PmlCommonEntry * entry;
+    int level;
+
+    Handle res = walker.Find(vaddr, entry, level);
 
-    return cbk(reinterpret_cast<PmlCommonEntry *>(&pml1e), 1);
+    if unlikely(res != HandleResult::Okay)
+        return res;
+
+    return cbk(entry, level);
 }
 
 template<typename cbk_t>
@@ -488,10 +818,6 @@ static __hot Handle MapPageInternal(Process * const proc
     , bool const lockAlien
     , bool const nonLocal)
 {
-    uint16_t ind;   //  Used to hold the current index.
-
-    Pml4 * pml4p; Pml3 * pml3p; Pml2 * pml2p; Pml1 * pml1p;
-
     SmpLock * alienLock = nullptr, * heapLock = nullptr;
 
     if (lockAlien && nonLocal && CpuDataSetUp)
@@ -499,35 +825,7 @@ static __hot Handle MapPageInternal(Process * const proc
 
     LockGuardFlexible<SmpLock > pml4Lg {alienLock};
 
-    if (nonLocal)
-    {
-        Alienate(proc);
-
-        pml4p = VmmArc::GetAlienPml4();
-        pml3p = VmmArc::GetAlienPml3(vaddr);
-        pml2p = VmmArc::GetAlienPml2(vaddr);
-        pml1p = VmmArc::GetAlienPml1(vaddr);
-
-        if (!CpuDataSetUp || proc->PagingTable != VmmArc::LastAlienPml4)
-        {
-            CpuInstructions::InvalidateTlb(pml4p);
-            CpuInstructions::InvalidateTlb(pml3p);
-            CpuInstructions::InvalidateTlb(pml2p);
-            CpuInstructions::InvalidateTlb(pml1p);
-
-            //  Invalidate all!
-
-            if (CpuDataSetUp)
-                VmmArc::LastAlienPml4 = proc->PagingTable;
-        }
-    }
-    else
-    {
-        pml4p = VmmArc::GetLocalPml4();
-        pml3p = VmmArc::GetLocalPml3(vaddr);
-        pml2p = VmmArc::GetLocalPml2(vaddr);
-        pml1p = VmmArc::GetLocalPml1(vaddr);
-    }
+    PageWalker walker {proc, nonLocal};
 
     if (lockHeap)
         heapLock = (vaddr < VmmArc::LowerHalfEnd
@@ -536,113 +834,23 @@ static __hot Handle MapPageInternal(Process * const proc
 
     LockGuardFlexible<SmpLock > heapLg {heapLock};
 
-    ind = VmmArc::GetPml4Index(vaddr);
-
-    if unlikely(!pml4p->operator[](ind).GetPresent())
-    {
-        //  So there's no PML4e. Means all PML1-3 need allocation.
-
-        //  First grab a PML3.
-
-        paddr_t const newPml3 = Pmm::AllocateFrame(1);
-
-        if (newPml3 == nullpaddr)
-            return HandleResult::OutOfMemory;
-
-        pml4p->operator[](ind) = Pml4Entry(newPml3, true, true, true, false);
-        //  Present, writable, user-accessible, executable.
-
-        //  Then a PML2.
-
-        paddr_t const newPml2 = Pmm::AllocateFrame(1);
-
-        if (newPml2 == nullpaddr)
-        {
-            Pmm::FreeFrame(newPml3);
-            //  Yes, clean up.
-
-            return HandleResult::OutOfMemory;
-        }
-
-        memset(pml3p, 0, PageSize);
-        pml3p->operator[](VmmArc::GetPml3Index(vaddr)) = Pml3Entry(newPml2, true, true, true, false);
-        //  First clean, then assign an entry.
-
-        //  And finish by moving on.
-
-        memset(pml2p, 0, PageSize);
-
-        goto do_pml2e;
-    }
-
-    ind = VmmArc::GetPml3Index(vaddr);
-
-    if unlikely(!pml3p->operator[](ind).GetPresent())
-    {
-        //  Just grab a PML2.
-
-        paddr_t const newPml2 = Pmm::AllocateFrame(1);
-
-        if (newPml2 == nullpaddr)
-            return HandleResult::OutOfMemory;
-
-        pml3p->operator[](ind) = Pml3Entry(newPml2, true, true, true, false);
-        //  First clean, then assign an entry.
-
-        memset(pml2p, 0, PageSize);
-    }
-    
-do_pml2e:
-    ind = VmmArc::GetPml2Index(vaddr);
+    return walker.Map(vaddr, paddr, size, flags);
+}
 
-    if unlikely(!pml2p->operator[](ind).GetPresent())
+bool Vmm::SupportsFrameSize(FrameSize size)
+{
+    switch (size)
     {
-        if likely(size == FrameSize::_4KiB)
-        {
-            paddr_t const newPml1 = Pmm::AllocateFrame(1);
-
-            if (newPml1 == nullpaddr)
-                return HandleResult::OutOfMemory;
-
-            pml2p->operator[](ind) = Pml2Entry(newPml1, true, true, true, false);
-            //  Present, writable, user-accessible, executable.
-
-            memset(pml1p, 0, PageSize);
-
-            goto do_pml1e;
-        }
-        else
-        {
-            pml2p->operator[](ind) = Pml2Entry(paddr, true
-                , 0 != (flags & MemoryFlags::Writable)
-                , 0 != (flags & MemoryFlags::Userland)
-                , 0 != (flags & MemoryFlags::Global)
-                , 0 == (flags & MemoryFlags::Executable) && VmmArc::NX);
-            //  Present, writable, user-accessible, global, executable.
-
-            return HandleResult::Okay;
-        }
-    }
-    
-    ind = VmmArc::GetPml1Index(vaddr);
-
-    if unlikely(pml1p->operator[](ind).GetPresent())
-        return HandleResult::PageMapped;
+    case FrameSize::_4KiB:
+    case FrameSize::_2MiB:
+        return true;
 
-    if likely(size == FrameSize::_4KiB)
-    {
-    do_pml1e:
-        pml1p->operator[](VmmArc::GetPml1Index(vaddr)) = Pml1Entry(paddr, true
-            , 0 != (flags & MemoryFlags::Writable)
-            , 0 != (flags & MemoryFlags::Userland)
-            , 0 != (flags & MemoryFlags::Global)
-            , 0 == (flags & MemoryFlags::Executable) && VmmArc::NX);
-        //  Present, writable, user-accessible, global, executable.
+    case FrameSize::_1GiB:
+        return VmmArc::Page1GB;
 
-        return HandleResult::Okay;
+    default:
+        return false;
     }
-    else
-        return HandleResult::PageMapped;
 }
 
 Handle Vmm::MapPage(Process * proc, vaddr_t const vaddr, paddr_t paddr
@@ -656,17 +864,25 @@ Handle Vmm::MapPage(Process * proc, vaddr_t const vaddr, paddr_t paddr
     {
     case FrameSize::_64KiB: //  TODO: Map 4-KiB pages to provide this.
     case FrameSize::_4MiB:  //  TODO: Map 2-MiB pages to provide this.
-    case FrameSize::_1GiB:
         FAIL("A request was made for a frame size which is not supported by this architecture.");
         break;
 
-    case FrameSize::_4KiB:
-        if unlikely(!Is4KiBAligned(vaddr) || !Is4KiBAligned(paddr))
+    case FrameSize::_1GiB:
+        if unlikely(!VmmArc::Page1GB)
+            return HandleResult::UnsupportedOperation;
+
+        if unlikely(!Is1GiBAligned(vaddr) || !Is1GiBAligned(paddr))
             return HandleResult::AlignmentFailure;
 
         break;
 
-    case FrameSize::_2MiB:
+    case FrameSize::_4KiB:
+        if unlikely(!Is4KiBAligned(vaddr) || !Is4KiBAligned(paddr))
+            return HandleResult::AlignmentFailure;
+
+        break;
+
+    case FrameSize::_2MiB:
         if unlikely(!Is2MiBAligned(vaddr) || !Is2MiBAligned(paddr))
             return HandleResult::AlignmentFailure;
 
@@ -748,6 +964,9 @@ Handle Vmm::MapRange(Process * proc
         LockGuardFlexible<SmpLock > pml4Lg {alienLock};
         LockGuardFlexible<SmpLock > heapLg {heapLock};
 
+        PageWalker walker {proc, nonLocal};
+        //  Descends only at table boundaries.
+
         if ((vaddr.Value & (LargePageSize.Value - 1)) == (paddr.Value & (LargePageSize.Value - 1)))
         {
             //  Wow, so the alignment matches. This means 2-MiB mappings can be used!
@@ -755,24 +974,45 @@ Handle Vmm::MapRange(Process * proc
 
             for (/* nothing */; vaddr < end && !Is2MiBAligned(vaddr); vaddr += PageSize, paddr += PageSize)
             {
-                res = MapPageInternal(proc, vaddr, paddr
-                    , FrameSize::_4KiB, flags
-                    , false, false, nonLocal);
+                res = walker.Map(vaddr, paddr, FrameSize::_4KiB, flags);
 
                 if unlikely(res != HandleResult::Okay)
                     return res;
             }
 
-            //  Now map as many 2-MiB pages as possible.
-
             vaddr_t const endRD = RoundDown(end, LargePageSize);
             //  endRD = end rounded down to 2-MiB
 
+            if (VmmArc::Page1GB && (vaddr.Value & (HugePageSize.Value - 1)) == (paddr.Value & (HugePageSize.Value - 1)))
+            {
+                //  The alignment matches even for 1-GiB mappings! So 2-MiB pages
+                //  are mapped until a 1-GiB aligned address is reached.
+
+                for (/* nothing */; vaddr < endRD && !Is1GiBAligned(vaddr); vaddr += LargePageSize, paddr += LargePageSize)
+                {
+                    res = walker.Map(vaddr, paddr, FrameSize::_2MiB, flags);
+
+                    if unlikely(res != HandleResult::Okay)
+                        return res;
+                }
+
+                vaddr_t const endRH = RoundDown(end, HugePageSize);
+                //  endRH = end rounded down to 1-GiB
+
+                for (/* nothing */; vaddr < endRH; vaddr += HugePageSize, paddr += HugePageSize)
+                {
+                    res = walker.Map(vaddr, paddr, FrameSize::_1GiB, flags);
+
+                    if unlikely(res != HandleResult::Okay)
+                        return res;
+                }
+            }
+
+            //  Now map as many 2-MiB pages as possible.
+
             for (/* nothing */; vaddr < endRD; vaddr += LargePageSize, paddr += LargePageSize)
             {
-                res = MapPageInternal(proc, vaddr, paddr
-                    , FrameSize::_2MiB, flags
-                    , false, false, nonLocal);
+                res = walker.Map(vaddr, paddr, FrameSize::_2MiB, flags);
 
                 if unlikely(res != HandleResult::Okay)
                     return res;
@@ -784,9 +1024,7 @@ Handle Vmm::MapRange(Process * proc
 
         for (/* nothing */; vaddr < end; vaddr += PageSize, paddr += PageSize)
         {
-            res = MapPageInternal(proc, vaddr, paddr
-                , FrameSize::_4KiB, flags
-                , false, false, nonLocal);
+            res = walker.Map(vaddr, paddr, FrameSize::_4KiB, flags);
 
             if unlikely(res != HandleResult::Okay)
                 return res;
@@ -804,7 +1042,7 @@ Handle Vmm::UnmapPage(Process * proc, vaddr_t const vaddr
     Handle res = TryTranslate(proc, vaddr, [&paddr, &size](PmlCommonEntry * pE, int level)
     {
         paddr = pE->GetAddress();
-        size = level == 1 ? FrameSize::_4KiB : FrameSize::_2MiB;
+        size = GetLevelFrameSize(level);
 
         *pE = PmlCommonEntry();
         //  Null.
@@ -829,6 +1067,9 @@ Handle Vmm::UnmapPage(Process * proc, vaddr_t const vaddr
     Iterative Unmapping    >----------------------------------------------------
 **************************/
 
+static constexpr int const GatherCapacity = 16;
+static constexpr int const GatherFlushThreshold = 8;
+
 struct IterativeUnmapState
 {
     Execution::Process * const Process;
@@ -843,65 +1084,170 @@ struct IterativeUnmapState
     void * Cookie;
 };
 
-struct HybridPageEntry
+/**
+ *  <summary>
+ *  Replaces a large page with a table of small pages mapping the same frame,
+ *  so part of it can be unmapped. Each small page holds a reference to the
+ *  large frame.
+ *  </summary>
+ */
+static __hot Handle SplitLargePage(PmlCommonEntry * pE, vaddr_t const vaddr
+    , bool const nonLocal, bool const countRefs)
 {
-    vaddr_t VirtualAddress;
-    paddr_t PhysicalAddress;
-};
+    paddr_t const newPml1 = Pmm::AllocateFrame(1);
+
+    if (newPml1 == nullpaddr)
+        return HandleResult::OutOfMemory;
+
+    PmlCommonEntry const large = *pE;
+    Pml1 * const pml1p = nonLocal ? VmmArc::GetAlienPml1(vaddr) : VmmArc::GetLocalPml1(vaddr);
 
-static constexpr int const UnmapListMax = 512;
-static __thread HybridPageEntry UnmapList[UnmapListMax];
-//  Enough to clear one table at a time.
+    *pE = Pml2Entry(newPml1, true, true, true, false);
+    //  Present, writable, user-accessible, executable.
 
-static __hot Handle UnmapIteratively(IterativeUnmapState * const state)
+    CpuInstructions::InvalidateTlb(pml1p);
+    //  The fractal mapping of the table used to reach the large frame.
+
+    for (uint16_t i = 0; i < 512; ++i)
+        pml1p->operator[](i) = Pml1Entry(large.GetAddress() + psize_t(i * PageSize.Value), true
+            , large.GetWritable()
+            , large.GetUserland()
+            , large.GetGlobal()
+            , large.GetXd());
+
+    if (countRefs)
+        Pmm::AdjustReferenceCount(large.GetAddress(), 511);
+    //  The large page held one reference.
+
+    return HandleResult::Okay;
+}
+
+/**
+ *  <summary>
+ *  Replaces a huge page with a table of large pages mapping the same frame.
+ *  Each large page holds a reference to the huge frame.
+ *  </summary>
+ */
+static __hot Handle SplitHugePage(PmlCommonEntry * pE, vaddr_t const vaddr
+    , bool const nonLocal, bool const countRefs)
+{
+    paddr_t const newPml2 = Pmm::AllocateFrame(1);
+
+    if (newPml2 == nullpaddr)
+        return HandleResult::OutOfMemory;
+
+    PmlCommonEntry const huge = *pE;
+    Pml2 * const pml2p = nonLocal ? VmmArc::GetAlienPml2(vaddr) : VmmArc::GetLocalPml2(vaddr);
+
+    *pE = Pml3Entry(newPml2, true, true, true, false);
+    //  Present, writable, user-accessible, executable.
+
+    CpuInstructions::InvalidateTlb(pml2p);
+    //  The fractal mapping of the table used to reach the huge frame.
+
+    for (uint16_t i = 0; i < 512; ++i)
+        pml2p->operator[](i) = Pml2Entry(huge.GetAddress() + psize_t(i * LargePageSize.Value), true
+            , huge.GetWritable()
+            , huge.GetUserland()
+            , huge.GetGlobal()
+            , huge.GetXd());
+
+    if (countRefs)
+        Pmm::AdjustReferenceCount(huge.GetAddress(), 511);
+    //  The huge page held one reference.
+
+    return HandleResult::Okay;
+}
+
+static __hot __noinline Handle UnmapIteratively(IterativeUnmapState * const state)
 {
     Handle res;
     vaddr_t const iterationStart = state->Address;
     int i;
 
-    for (i = 0; i < UnmapListMax && state->Address < state->EndAddress; ++i)
+    vaddr_t pages[GatherFlushThreshold];
+    paddr_t frames[GatherCapacity];
+    //  Pages unmapped in this round, which are invalidated together before
+    //  their frames are released in bulk. Past the threshold, the TLB is
+    //  flushed whole. They live in this call's frame, because the thread may
+    //  be preempted or moved to another core once interrupts are enabled.
+
+    PageWalker walker {state->Process, state->NonLocal};
+    //  The locks are held for the whole round.
+
+    for (i = 0; i < GatherCapacity && state->Address < state->EndAddress; ++i)
     {
         vaddr_t next;
         paddr_t paddr = nullpaddr;
         FrameSize fSize = FrameSize::_1GiB;
+        PmlCommonEntry * pE;
+        int level;
 
     retry:
         // if (::PrintMemoryOps)
         //     MSG_("Translating page %Xp...%n"
         //         , state->Address);
 
-        res = TranslateInternal(state->Process, state->Address
-            , [&paddr, &fSize](PmlCommonEntry * pE, int level)
+        res = walker.Find(state->Address, pE, level);
+
+        if unlikely(res != HandleResult::Okay)
+        {
+            if (res == HandleResult::PageUnmapped)
             {
-                paddr = pE->GetAddress();
-                fSize = level == 1 ? FrameSize::_4KiB : FrameSize::_2MiB;
+                next = walker.GetHoleEnd();
 
-                *pE = PmlCommonEntry();
-                //  Null.
+                if (next > state->Address && (state->Address = next) < state->EndAddress)
+                    goto retry;
 
-                return HandleResult::Okay;
-            }, false, false, state->NonLocal);
+                state->Address = state->EndAddress;
+            }
 
-        if unlikely(res != HandleResult::Okay)
+            break;
+            //  If the page is unmapped, skip the hole, unless the region's covered.
+        }
+
+        if (level >= 2)
         {
-            if (res == HandleResult::PageUnmapped && (state->Address += PageSize) < state->EndAddress)
+            vsize_t const pageSize = level == 2 ? LargePageSize : HugePageSize;
+            vaddr_t const span = RoundDown(state->Address, pageSize);
+
+            if (span < state->Address || span + pageSize > state->EndAddress)
+            {
+                if (level == 2)
+                    res = SplitLargePage(pE, state->Address, state->NonLocal, state->CountReferences);
+                else
+                    res = SplitHugePage(pE, state->Address, state->NonLocal, state->CountReferences);
+
+                if unlikely(res != HandleResult::Okay)
+                    break;
+
                 goto retry;
-            else
-                break;
-            //  If the page is unmapped, check the next page, unless the region's covered.
+                //  The address is now covered by a smaller page.
+            }
+            //  Only part of this page is unmapped.
         }
 
+        paddr = pE->GetAddress();
+        fSize = GetLevelFrameSize(level);
+
+        *pE = PmlCommonEntry();
+        //  Null.
+
         if (fSize == FrameSize::_4KiB)
             next = state->Address + PageSize;
-        else
+        else if (fSize == FrameSize::_2MiB)
             next = RoundUp(state->Address + vsize_t(1), LargePageSize);
+        else
+            next = RoundUp(state->Address + vsize_t(1), HugePageSize);
+
+        if (i < GatherFlushThreshold)
+            pages[i] = state->Address;
 
-        UnmapList[i] = HybridPageEntry { state->Address, paddr };
+        frames[i] = paddr;
 
         // if (::PrintMemoryOps)
-        //     MSG_("Unmap list item %i4: %Xp -> %XP%n"
-        //         , i, UnmapList[i].VirtualAddress
-        //         , UnmapList[i].PhysicalAddress);
+        //     MSG_("Gathered item %i4: %Xp -> %XP%n"
+        //         , i, state->Address, paddr);
 
         state->Address = next;
     }
@@ -921,10 +1267,14 @@ static __hot Handle UnmapIteratively(IterativeUnmapState * const state)
     {
         if likely(state->Invalidate)
         {
-            Handle res2 = Vmm::InvalidateRange(state->Process
-                , reinterpret_cast<vaddr_t const *>(UnmapList + offsetof(HybridPageEntry, VirtualAddress))
-                , i, sizeof(HybridPageEntry)
-                , state->Broadcast);
+            Handle res2;
+
+            if (i <= GatherFlushThreshold)
+                res2 = Vmm::InvalidateRange(state->Process, pages, i
+                    , sizeof(vaddr_t), state->Broadcast);
+            else
+                res2 = Vmm::FlushTlb(state->Process, iterationStart, state->Broadcast);
+            //  One shootdown either way; past the threshold, a flush is cheaper.
 
             if unlikely(res == HandleResult::Okay)
                 res = res2;
@@ -932,17 +1282,17 @@ static __hot Handle UnmapIteratively(IterativeUnmapState * const state)
 
         if likely(state->CountReferences)
         {
-            do
-            {
-                Handle res2 = Pmm::AdjustReferenceCount(UnmapList[--i].PhysicalAddress, -1);
-
-        #ifdef __BEELZEBUB__CONF_DEBUG
-                ASSERTX(res2 == HandleResult::Okay
-                    || res2 == HandleResult::PageReserved
-                    || res2 == HandleResult::PagesOutOfAllocatorRange)
-                    (res2)XEND;
-        #endif
-            } while (i > 0);
+            Handle res2 = Pmm::ReleaseFrames(frames, i);
+            //  No core can reach these frames anymore.
+
+    #ifdef __BEELZEBUB__CONF_DEBUG
+            ASSERTX(res2 == HandleResult::Okay
+                || res2 == HandleResult::PageReserved
+                || res2 == HandleResult::PagesOutOfAllocatorRange)
+                (res2)XEND;
+    #else
+            (void)res2;
+    #endif
         }
     }
 
@@ -994,7 +1344,7 @@ retry:
         , [&paddr, &fSize](PmlCommonEntry * pE, int level)
         {
             paddr = pE->GetAddress();
-            fSize = level == 1 ? FrameSize::_4KiB : FrameSize::_2MiB;
+            fSize = GetLevelFrameSize(level);
 
             *pE = PmlCommonEntry();
             //  Null.
@@ -1022,8 +1372,10 @@ retry:
 
     if (fSize == FrameSize::_4KiB)
         next = state->Address + PageSize;
-    else
+    else if (fSize == FrameSize::_2MiB)
         next = RoundUp(state->Address + vsize_t(1), LargePageSize);
+    else
+        next = RoundUp(state->Address + vsize_t(1), HugePageSize);
 
     state->Address = next;
 
@@ -1194,6 +1546,56 @@ Handle Vmm::UnmapRange(Process * proc
     Page Invaidation    >-------------------------------------------------------
 ***********************/
 
+/**
+ *  <summary>
+ *  Runs an invalidation function on the current core and posts it to every
+ *  other core which may hold translations of the given address.
+ *  </summary>
+ */
+static __hot void Shootdown(Process * proc, vaddr_t const vaddr
+    , MailFunction remote, MailFunction local, void * cookie)
+{
+    size_t const coreCount = Cores::GetCount();
+
+    if (IsShared(vaddr) || coreCount > Process::MaxTrackedCores)
+    {
+        ALLOCATE_MAIL_BROADCAST(mail, remote, cookie);
+        mail.SetAwait(true).Post(local, cookie);
+
+        return;
+    }
+
+    InterruptGuard<> intGuard;
+    //  The current core must not change while picking destinations.
+
+    size_t const self = Cpu::GetData()->Index;
+    uint64_t mask[Process::MaxTrackedCores / 64];
+    unsigned int count = 0;
+
+    for (size_t i = 0; i < Process::MaxTrackedCores / 64; ++i)
+    {
+        mask[i] = proc->ActiveCores[i].Load();
+
+        if (i == self / 64)
+            mask[i] &= ~(1ULL << (self % 64));
+
+        count += (unsigned int)__builtin_popcountll(mask[i]);
+    }
+    //  A snapshot, since cores may come and go. Those which arrive later will
+    //  not pick up stale entries anyway.
+
+    if (count == 0)
+        return local(cookie);
+
+    ALLOCATE_MAIL(mail, count, remote, cookie);
+
+    for (size_t i = 0, link = 0; i < Process::MaxTrackedCores / 64; ++i)
+        for (uint64_t bits = mask[i]; bits != 0; bits &= bits - 1)
+            mail.Links[link++] = MailboxEntryLink((uint32_t)(i * 64 + __builtin_ctzll(bits)));
+
+    mail.SetAwait(true).Post(local, cookie);
+}
+
 template<bool caller>
 static __hot __solid void RangeInvalidator(void * cookie)
 {
@@ -1224,18 +1626,16 @@ Handle Vmm::InvalidateRange(Process * proc
 {
     if unlikely(proc == nullptr) proc = likely(CpuDataSetUp) ? Cpu::GetProcess() : &BootstrapProcess;
 
-    if (broadcast && ((*addresses >= UserlandStart && *addresses < UserlandEnd && proc->ActiveCoreCount == 1 && !VmmArc::PCID) || unlikely(!Mailbox::IsReady())))
+    ExpireTags(proc, *addresses);
+    //  Cores where the process is not active will flush its tag upon switching.
+
+    if (broadcast && unlikely(!Mailbox::IsReady()))
         broadcast = false;
 
     RangeInvalidationInfo info { proc, addresses, count, stride, after, cookie };
 
     if (broadcast)
-    {
-        ALLOCATE_MAIL_BROADCAST(mail, &RangeInvalidator<false>, &info);
-        mail.SetAwait(true).Post(&RangeInvalidator<true>, &info);
-
-        //  Quite simple.
-    }
+        Shootdown(proc, *addresses, &RangeInvalidator<false>, &RangeInvalidator<true>, &info);
     else
         RangeInvalidator<true>(&info);
 
@@ -1265,20 +1665,73 @@ Handle Vmm::InvalidateChain(Process * proc, PageNode const * node, bool broadcas
 {
     if unlikely(proc == nullptr) proc = likely(CpuDataSetUp) ? Cpu::GetProcess() : &BootstrapProcess;
 
-    if (broadcast && ((node->Address >= UserlandStart && node->Address < UserlandEnd && proc->ActiveCoreCount == 1 && !VmmArc::PCID) || unlikely(!Mailbox::IsReady())))
+    ExpireTags(proc, node->Address);
+
+    if (broadcast && unlikely(!Mailbox::IsReady()))
         broadcast = false;
 
     ChainInvalidationInfo info { proc, node, after, cookie };
 
     if (broadcast)
+        Shootdown(proc, node->Address, &ChainInvalidator<false>, &ChainInvalidator<true>, &info);
+    else
+        ChainInvalidator<true>(&info);
+
+    return HandleResult::Okay;
+}
+
+template<bool caller>
+static __hot void ProcessTlbFlusher(void * cookie)
+{
+    if (Vmm::IsActive(reinterpret_cast<Process *>(cookie)))
+        Cpu::SetCr3(Cpu::GetCr3());
+    //  Per-process pages are never global, so this drops all of them.
+
+    COMPILER_MEMORY_BARRIER();
+}
+
+template<bool caller>
+static __hot void GlobalTlbFlusher(void * cookie)
+{
+    (void)cookie;
+
+    Cr4 const cr4 = Cpu::GetCr4();
+
+    if (cr4.GetPge())
     {
-        ALLOCATE_MAIL_BROADCAST(mail, &ChainInvalidator<false>, &info);
-        mail.SetAwait(true).Post(&ChainInvalidator<true>, &info);
+        Cpu::SetCr4(Cr4(cr4.Value).SetPge(false));
+        Cpu::SetCr4(cr4);
+        //  Toggling global pages drops every entry, under every tag.
+    }
+    else
+        Cpu::SetCr3(Cpu::GetCr3());
 
-        //  Quite simple.
+    COMPILER_MEMORY_BARRIER();
+}
+
+Handle Vmm::FlushTlb(Process * proc, vaddr_t const vaddr, bool broadcast)
+{
+    if unlikely(proc == nullptr) proc = likely(CpuDataSetUp) ? Cpu::GetProcess() : &BootstrapProcess;
+
+    ExpireTags(proc, vaddr);
+
+    if (broadcast && unlikely(!Mailbox::IsReady()))
+        broadcast = false;
+
+    if (IsShared(vaddr))
+    {
+        if (broadcast)
+            Shootdown(proc, vaddr, &GlobalTlbFlusher<false>, &GlobalTlbFlusher<true>, nullptr);
+        else
+            GlobalTlbFlusher<true>(nullptr);
     }
     else
-        ChainInvalidator<true>(&info);
+    {
+        if (broadcast)
+            Shootdown(proc, vaddr, &ProcessTlbFlusher<false>, &ProcessTlbFlusher<true>, proc);
+        else
+            ProcessTlbFlusher<true>(proc);
+    }
 
     return HandleResult::Okay;
 }
@@ -1323,13 +1776,13 @@ Handle Vmm::SetPageFlags(Process * proc, vaddr_t const vaddr
 {
     if (proc == nullptr) proc = likely(CpuDataSetUp) ? Cpu::GetProcess() : &BootstrapProcess;
 
-    Handle res = TryTranslate(proc, vaddr, [flags](PmlCommonEntry * pE, int level)
+    Handle res = TryTranslate(proc, vaddr, [vaddr, flags](PmlCommonEntry * pE, int level)
     {
         (void)level;
         
         PmlCommonEntry e = *pE;
 
-        e.SetGlobal( ((MemoryFlags::Global     & flags) != 0))
+        e.SetGlobal( ((MemoryFlags::Global     & flags) != 0) || (VmmArc::PCID && IsShared(vaddr)))
         .SetUserland(((MemoryFlags::Userland   & flags) != 0))
         .SetWritable(((MemoryFlags::Writable   & flags) != 0))
         .SetXd( VmmArc::NX & ((MemoryFlags::Executable & flags) == 0));
@@ -1345,6 +1798,536 @@ Handle Vmm::SetPageFlags(Process * proc, vaddr_t const vaddr
     return Vmm::InvalidatePage(proc, vaddr, true);
 }
 
+Handle Vmm::SetRangeFlags(Process * proc, vaddr_t vaddr, vsize_t size
+    , MemoryFlags const flags, bool const lock)
+{
+    if unlikely((vaddr + size > VmmArc::FractalStart && vaddr < VmmArc::FractalEnd     )
+             || (vaddr + size > VmmArc::LowerHalfEnd && vaddr < VmmArc::HigherHalfStart))
+        return HandleResult::PageMapIllegalRange;
+
+    if unlikely(!Is4KiBAligned(vaddr) || !Is4KiBAligned(size))
+        return HandleResult::AlignmentFailure;
+
+    if (proc == nullptr) proc = likely(CpuDataSetUp) ? Cpu::GetProcess() : &BootstrapProcess;
+
+    vaddr_t const start = vaddr, end = vaddr + size;
+    bool const nonLocal = (vaddr < VmmArc::LowerHalfEnd) && !Vmm::IsActive(proc);
+
+    SmpLock * alienLock = nullptr, * heapLock = nullptr;
+
+    if (nonLocal && CpuDataSetUp)
+        alienLock = &(Cpu::GetProcess()->AlienPagingTablesLock);
+
+    if (lock)
+        heapLock = (vaddr < VmmArc::LowerHalfEnd
+            ? &(proc->LocalTablesLock)
+            : &(Vmm::KernelHeapLock));
+
+    vaddr_t pages[GatherFlushThreshold];
+    size_t count = 0;
+    Handle res = HandleResult::Okay;
+
+    bool const global = ((MemoryFlags::Global     & flags) != 0) || (VmmArc::PCID && IsShared(vaddr));
+    bool const user   = ((MemoryFlags::Userland   & flags) != 0);
+    bool const write  = ((MemoryFlags::Writable   & flags) != 0);
+    bool const xd     = VmmArc::NX & ((MemoryFlags::Executable & flags) == 0);
+
+    withInterrupts (false)
+    {
+        LockGuardFlexible<SmpLock > pml4Lg {alienLock};
+        LockGuardFlexible<SmpLock > heapLg {heapLock};
+
+        PageWalker walker {proc, nonLocal};
+
+        while (vaddr < end)
+        {
+            PmlCommonEntry * pE;
+            int level;
+
+            res = walker.Find(vaddr, pE, level);
+
+            if unlikely(res != HandleResult::Okay)
+                break;
+
+            PmlCommonEntry e = *pE;
+
+            e.SetGlobal(global).SetUserland(user).SetWritable(write).SetXd(xd);
+
+            *pE = e;
+
+            if (count < GatherFlushThreshold)
+                pages[count] = vaddr;
+
+            ++count;
+
+            vaddr_t const next = RoundUp(vaddr + vsize_t(1), level == 1 ? PageSize
+                : (level == 2 ? LargePageSize : HugePageSize));
+
+            if unlikely(next <= vaddr)
+                break;
+            //  Reached the end of memory.
+
+            vaddr = next;
+        }
+    }
+
+    if (count == 0)
+        return res;
+    else if (count <= GatherFlushThreshold)
+        Vmm::InvalidateRange(proc, pages, count, sizeof(vaddr_t), true);
+    else
+        Vmm::FlushTlb(proc, start, true);
+    //  Even if a hole was found, the changed pages must be invalidated.
+
+    return res;
+}
+
+/*  Large Pages  */
+
+/**
+ *  <summary>
+ *  Finds the local PML2 entry which refers to the table of small pages that
+ *  covers the given address.
+ *  </summary>
+ *  <return>PageUnmapped if there is no such table; PageMapped if a larger page covers the address.</return>
+ */
+static __hot Handle FindSmallTable(vaddr_t const vaddr, Pml2Entry * & pml2e)
+{
+    if unlikely(!VmmArc::GetLocalPml4()->operator[](VmmArc::GetPml4Index(vaddr)).GetPresent())
+        return HandleResult::PageUnmapped;
+
+    Pml3Entry & pml3e = VmmArc::GetLocalPml3(vaddr)->operator[](VmmArc::GetPml3Index(vaddr));
+
+    if unlikely(!pml3e.GetPresent())
+        return HandleResult::PageUnmapped;
+    else if unlikely(pml3e.GetPageSize())
+        return HandleResult::PageMapped;
+
+    pml2e = &(VmmArc::GetLocalPml2(vaddr)->operator[](VmmArc::GetPml2Index(vaddr)));
+
+    if (!pml2e->GetPresent())
+        return HandleResult::PageUnmapped;
+    else if (pml2e->GetPageSize())
+        return HandleResult::PageMapped;
+
+    return HandleResult::Okay;
+}
+
+template<bool caller>
+static __hot void SpanInvalidator(void * cookie)
+{
+    vaddr_t const vaddr = *reinterpret_cast<vaddr_t const *>(cookie);
+
+    for (size_t i = 0; i < LargePageSize.Value; i += PageSize.Value)
+        CpuInstructions::InvalidateTlb(vaddr + vsize_t(i));
+    //  This also drops any cached reference to the table of small pages.
+
+    ForgetTags(vaddr);
+    //  But only under the current tag, if the table is shared.
+
+    COMPILER_MEMORY_BARRIER();
+}
+
+static __hot void InvalidateSpan(Process * proc, vaddr_t vaddr)
+{
+    ExpireTags(proc, vaddr);
+
+    if likely(Mailbox::IsReady())
+        Shootdown(proc, vaddr, &SpanInvalidator<false>, &SpanInvalidator<true>, &vaddr);
+    else
+        SpanInvalidator<true>(&vaddr);
+}
+
+Handle Vmm::CountSmallPages(Process * proc, vaddr_t const vaddr, size_t & count)
+{
+    if unlikely(!Is2MiBAligned(vaddr))
+        return HandleResult::AlignmentFailure;
+
+    if (proc == nullptr) proc = likely(CpuDataSetUp) ? Cpu::GetProcess() : &BootstrapProcess;
+
+    if unlikely(vaddr < VmmArc::LowerHalfEnd && !Vmm::IsActive(proc))
+        return HandleResult::UnsupportedOperation;
+    //  Only the active tables are walked here.
+
+    SmpLock * const lock = vaddr < VmmArc::LowerHalfEnd ? &(proc->LocalTablesLock) : &(Vmm::KernelHeapLock);
+
+    count = 0;
+
+    withInterrupts (false)
+    {
+        LockGuardFlexible<SmpLock > heapLg {lock};
+
+        Pml2Entry * pml2e;
+        Handle res = FindSmallTable(vaddr, pml2e);
+
+        if (res == HandleResult::Okay)
+        {
+            Pml1 & pml1 = *(VmmArc::GetLocalPml1(vaddr));
+
+            for (uint16_t i = 0; i < 512; ++i)
+                if (pml1[i].GetPresent())
+                    ++count;
+        }
+
+        return res;
+    }
+
+    __unreachable_code;
+}
+
+Handle Vmm::CollapseLargePage(Process * proc, vaddr_t const vaddr)
+{
+    if unlikely(!Is2MiBAligned(vaddr))
+        return HandleResult::AlignmentFailure;
+
+    if unlikely(!CpuDataSetUp)
+        return HandleResult::UnsupportedOperation;
+    //  The contents are copied through the frame window of this core.
+
+    if (proc == nullptr) proc = Cpu::GetProcess();
+
+    if unlikely(vaddr < VmmArc::LowerHalfEnd && !Vmm::IsActive(proc))
+        return HandleResult::UnsupportedOperation;
+    //  The small pages are read through their own mapping.
+
+    SmpLock * const lock = vaddr < VmmArc::LowerHalfEnd ? &(proc->LocalTablesLock) : &(Vmm::KernelHeapLock);
+    Pml1 & pml1 = *(VmmArc::GetLocalPml1(vaddr));
+
+    paddr_t const large = Pmm::AllocateFrame(FrameSize::_2MiB);
+
+    if unlikely(large == nullpaddr)
+        return HandleResult::OutOfMemory;
+
+    Handle res;
+    paddr_t table;
+    Pml1Entry first;
+
+    withInterrupts (false)
+    {
+        //  First, the table must be full and uniform. Its pages are made
+        //  read-only while their contents are copied, so no write is lost.
+
+        {
+            LockGuardFlexible<SmpLock > heapLg {lock};
+
+            Pml2Entry * pml2e;
+            res = FindSmallTable(vaddr, pml2e);
+
+            if (res != HandleResult::Okay)
+                goto fail;
+
+            table = pml2e->GetAddress();
+            first = pml1[(uint16_t)0];
+
+            for (uint16_t i = 0; i < 512; ++i)
+            {
+                Pml1Entry const e = pml1[i];
+
+                if (!e.GetPresent()
+                    || e.GetWritable() != first.GetWritable()
+                    || e.GetUserland() != first.GetUserland()
+                    || e.GetGlobal()   != first.GetGlobal()
+                    || e.GetXd()       != first.GetXd())
+                {
+                    res = HandleResult::PageUnmapped;
+
+                    goto fail;
+                }
+            }
+
+            if (first.GetWritable())
+                for (uint16_t i = 0; i < 512; ++i)
+                    pml1[i].SetWritable(false);
+        }
+
+        if (first.GetWritable())
+            InvalidateSpan(proc, vaddr);
+
+        vaddr_t const window = Cpu::GetData()->FrameWindow;
+
+        for (size_t offset = 0; offset < LargePageSize.Value; offset += PageSize.Value)
+        {
+            Vmm::MapPage(nullptr, window, large + psize_t(offset), MemoryFlags::Global | MemoryFlags::Writable
+                , MemoryMapOptions::NoLocking | MemoryMapOptions::NoReferenceCounting);
+
+            memcpy(window, vaddr + vsize_t(offset), PageSize);
+
+            paddr_t dummyAddr;
+            FrameSize dummySize;
+
+            Vmm::UnmapPage(nullptr, window, dummyAddr, dummySize
+                , MemoryMapOptions::NoLocking | MemoryMapOptions::NoReferenceCounting | MemoryMapOptions::NoBroadcasting);
+        }
+
+        //  Now the table is swapped for the large page.
+
+        {
+            LockGuardFlexible<SmpLock > heapLg {lock};
+
+            VmmArc::GetLocalPml2(vaddr)->operator[](VmmArc::GetPml2Index(vaddr)) = Pml2Entry(large, true
+                , first.GetWritable()
+                , first.GetUserland()
+                , first.GetGlobal()
+                , first.GetXd());
+            //  The caller's hold on the VAS lock keeps the table in place.
+        }
+
+        InvalidateSpan(proc, vaddr);
+
+        //  Finally, the references to the small frames are dropped, reading the
+        //  old table through the window.
+
+        Vmm::MapPage(nullptr, window, table, MemoryFlags::Global
+            , MemoryMapOptions::NoLocking | MemoryMapOptions::NoReferenceCounting);
+
+        Pml1 const & old = *reinterpret_cast<Pml1 const *>(window.Value);
+
+        for (uint16_t i = 0; i < 512; ++i)
+            Pmm::AdjustReferenceCount(old.Entries[i].GetAddress(), -1);
+
+        paddr_t dummyAddr;
+        FrameSize dummySize;
+
+        Vmm::UnmapPage(nullptr, window, dummyAddr, dummySize
+            , MemoryMapOptions::NoLocking | MemoryMapOptions::NoReferenceCounting | MemoryMapOptions::NoBroadcasting);
+    }
+
+    Pmm::FreeFrame(table);
+
+    res = Pmm::AdjustReferenceCount(large, 1);
+
+    if (res.IsResult(HandleResult::PagesOutOfAllocatorRange))
+        return HandleResult::Okay;
+    else
+        return res;
+
+fail:
+    Pmm::FreeFrame(large);
+
+    return res;
+}
+
+/*  Copy-on-Write  */
+
+Handle Vmm::ClonePagingTables(Process * src, Process * dst)
+{
+    if (src == nullptr) src = likely(CpuDataSetUp) ? Cpu::GetProcess() : &BootstrapProcess;
+
+    if unlikely(!Vmm::IsActive(src) || Vmm::IsActive(dst))
+        return HandleResult::UnsupportedOperation;
+    //  The source is walked locally, the destination as an alien.
+
+    Handle res = HandleResult::Okay;
+
+    SmpLock * alienLock = nullptr;
+
+    if (CpuDataSetUp)
+        alienLock = &(Cpu::GetProcess()->AlienPagingTablesLock);
+
+    withInterrupts (false)
+    {
+        LockGuardFlexible<SmpLock > pml4Lg {alienLock};
+        LockGuardFlexible<SmpLock > srcLg {&(src->LocalTablesLock)};
+        LockGuardFlexible<SmpLock > dstLg {&(dst->LocalTablesLock)};
+
+        auto share = [dst, &res](PmlCommonEntry & e, vaddr_t vaddr, FrameSize size) -> Handle
+        {
+            if (!e.GetUserland())
+                return HandleResult::Okay;
+            //  Supervisor pages in the lower half are not part of the process.
+
+            e.SetWritable(false);
+            //  Whichever process writes first gets its own copy.
+
+            MemoryFlags flags = MemoryFlags::None;
+
+            if (  e.GetGlobal())            flags |= MemoryFlags::Global;
+            if (  e.GetUserland())          flags |= MemoryFlags::Userland;
+            if (!(e.GetXd() && VmmArc::NX)) flags |= MemoryFlags::Executable;
+
+            res = MapPageInternal(dst, vaddr, e.GetAddress(), size, flags
+                , false, false, true);
+
+            if unlikely(res != HandleResult::Okay)
+                return res;
+
+            res = Pmm::AdjustReferenceCount(e.GetAddress(), 1);
+
+            if (res.IsResult(HandleResult::PagesOutOfAllocatorRange))
+                return HandleResult::Okay;
+            else
+                return res;
+        };
+
+        Pml4 & pml4 = *(VmmArc::GetLocalPml4());
+
+        for (uint16_t i4 = 0; i4 < 256; ++i4)
+        {
+            if (!pml4[i4].GetPresent())
+                continue;
+
+            vaddr_t const a4 { (uintptr_t)i4 << 39 };
+            Pml3 & pml3 = *(VmmArc::GetLocalPml3(a4));
+
+            for (uint16_t i3 = 0; i3 < 512; ++i3)
+            {
+                vaddr_t const a3 { a4.Value | ((uintptr_t)i3 << 30) };
+                Pml3Entry & e3 = pml3[i3];
+
+                if (!e3.GetPresent())
+                    continue;
+
+                if (e3.GetPageSize() && e3.GetUserland())
+                {
+                    if unlikely((res = SplitHugePage(&e3, a3, false, true)) != HandleResult::Okay)
+                        goto end;
+                    //  Copy-on-write works on large pages at most, so the huge
+                    //  page is shared as large pages instead.
+                }
+                else if (e3.GetPageSize())
+                    continue;
+
+                Pml2 & pml2 = *(VmmArc::GetLocalPml2(a3));
+
+                for (uint16_t i2 = 0; i2 < 512; ++i2)
+                {
+                    vaddr_t const a2 { a3.Value | ((uintptr_t)i2 << 21) };
+                    Pml2Entry & e2 = pml2[i2];
+
+                    if (!e2.GetPresent())
+                        continue;
+
+                    if (e2.GetPageSize())
+                    {
+                        if unlikely((res = share(e2, a2, FrameSize::_2MiB)) != HandleResult::Okay)
+                            goto end;
+
+                        continue;
+                    }
+
+                    Pml1 & pml1 = *(VmmArc::GetLocalPml1(a2));
+
+                    for (uint16_t i1 = 0; i1 < 512; ++i1)
+                        if (pml1[i1].GetPresent())
+                            if unlikely((res = share(pml1[i1], vaddr_t { a2.Value | ((uintptr_t)i1 << 12) }
+                                , FrameSize::_4KiB)) != HandleResult::Okay)
+                                goto end;
+                }
+            }
+        }
+
+    end:;
+    }
+
+    Vmm::FlushTlb(src, nullvaddr, true);
+    //  Whatever was write-protected must be seen as such everywhere.
+
+    return res;
+}
+
+Handle Vmm::BreakCopyOnWrite(Process * proc, vaddr_t const vaddr)
+{
+    if unlikely(!CpuDataSetUp)
+        return HandleResult::UnsupportedOperation;
+    //  The copy is made through the frame window of this core.
+
+    if (proc == nullptr) proc = Cpu::GetProcess();
+
+    if unlikely(vaddr >= VmmArc::LowerHalfEnd || !Vmm::IsActive(proc))
+        return HandleResult::UnsupportedOperation;
+
+    vaddr_t const page = RoundDown(vaddr, PageSize);
+    paddr_t old = nullpaddr;
+    Handle res;
+
+    withInterrupts (false)
+    {
+        LockGuardFlexible<SmpLock > heapLg {&(proc->LocalTablesLock)};
+
+        res = TranslateInternal(proc, page, [page, &old](PmlCommonEntry * pE, int level) -> Handle
+        {
+            if (pE->GetWritable())
+                return HandleResult::Okay;
+            //  Another thread got here first.
+
+            if (level == 3)
+            {
+                Handle res2 = SplitHugePage(pE, page, false, true);
+
+                if unlikely(res2 != HandleResult::Okay)
+                    return res2;
+
+                pE = &(VmmArc::GetLocalPml2(page)->operator[](VmmArc::GetPml2Index(page)));
+                level = 2;
+                //  Then the large page covering the address is split too.
+            }
+
+            if (level == 2)
+            {
+                Handle res2 = SplitLargePage(pE, page, false, true);
+
+                if unlikely(res2 != HandleResult::Okay)
+                    return res2;
+
+                pE = &(VmmArc::GetLocalPml1(page)->operator[](VmmArc::GetPml1Index(page)));
+            }
+
+            PmlCommonEntry e = *pE;
+
+            FrameSize size;
+            uint32_t refCnt;
+
+            if (level == 1
+                && Pmm::GetFrameInfo(e.GetAddress(), size, refCnt) == HandleResult::PageInUse
+                && size == FrameSize::_4KiB && refCnt == 1)
+            {
+                pE->SetWritable(true);
+
+                return HandleResult::Okay;
+            }
+            //  The last process to hold the frame can simply write to it.
+
+            paddr_t const fresh = Pmm::AllocateFrame(FrameSize::_4KiB, AddressMagnitude::Any, 1);
+
+            if unlikely(fresh == nullpaddr)
+                return HandleResult::OutOfMemory;
+
+            vaddr_t const window = Cpu::GetData()->FrameWindow;
+
+            Vmm::MapPage(nullptr, window, fresh, MemoryFlags::Global | MemoryFlags::Writable
+                , MemoryMapOptions::NoLocking | MemoryMapOptions::NoReferenceCounting);
+
+            memcpy(window, page, PageSize);
+
+            paddr_t dummyAddr;
+            FrameSize dummySize;
+
+            Vmm::UnmapPage(nullptr, window, dummyAddr, dummySize
+                , MemoryMapOptions::NoLocking | MemoryMapOptions::NoReferenceCounting | MemoryMapOptions::NoBroadcasting);
+
+            old = e.GetAddress();
+
+            e.SetAddress(fresh);
+            e.SetWritable(true);
+
+            *pE = e;
+
+            return HandleResult::Okay;
+        }, false, false, false);
+    }
+
+    if (res == HandleResult::Okay)
+    {
+        Vmm::InvalidatePage(proc, page, true);
+
+        if (old != nullpaddr)
+            Pmm::AdjustReferenceCount(old, -1);
+        //  Only dropped once no core can reach the old frame through this page.
+    }
+
+    return res;
+}
+
 /*  Utils  */
 
 Handle Vmm::AcquirePoolForVas(size_t objectSize, size_t headerSize
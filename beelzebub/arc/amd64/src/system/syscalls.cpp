@@ -40,6 +40,7 @@
 #include "system/syscalls.hpp"
 #include "syscalls.kernel.hpp"
 #include "system/msrs.hpp"
+#include "system/cpu.hpp"
 #include "entry.h"
 
 #include <beel/sync/smp.lock.hpp>
@@ -69,6 +70,10 @@ void Syscall::Initialize()
     if (BootstrapCpuid.Vendor == CpuVendor::Intel)
         Msrs::SetEfer(Msrs::GetEfer().SetSyscallEnable(true));
 
+    if (BootstrapCpuid.CheckFeature(CpuFeature::RDTSP))
+        Msrs::Write(Msr::IA32_TSC_AUX, (uint64_t)Cpu::GetData()->Index);
+    //  Lets userland find out which core it's running on without a syscall.
+
     withLock (InitLock)
     {
         if likely(!Initialized)
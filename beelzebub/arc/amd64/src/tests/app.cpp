@@ -44,6 +44,7 @@
 #include <execution/runtime64.hpp>
 #include <execution/thread.hpp>
 #include <execution/thread_init.hpp>
+#include <scheduler.hpp>
 #include <execution/ring_3.hpp>
 #include <memory/vmm.hpp>
 
@@ -142,8 +143,11 @@ void TestApplication()
     InitializeThreadState(&testThread);
     //  This sets up the thread so it goes directly to the entry point when switched to.
 
-    withInterrupts (false)
-        BootstrapThread.IntroduceNext(&testThread);
+    res = Scheduler::Enqueue(&testThread);
+
+    ASSERT(res.IsOkayResult()
+        , "Failed to schedule test userland thread: %H."
+        , res);
 
     // DEBUG_TERM_ << "Initialized app test main thread." << Terminals::EndLine;
 
@@ -170,8 +174,11 @@ void TestApplication()
     InitializeThreadState(&testWatcher);
     //  This sets up the thread so it goes directly to the entry point when switched to.
 
-    withInterrupts (false)
-        testThread.IntroduceNext(&testWatcher);
+    res = Scheduler::Enqueue(&testWatcher);
+
+    ASSERT(res.IsOkayResult()
+        , "Failed to schedule test watcher thread: %H."
+        , res);
 
     // DEBUG_TERM_ << "Initialized app test watcher thread." << Terminals::EndLine;
 
@@ -104,6 +104,8 @@ namespace Beelzebub { namespace System
         static acpi_table_xsdt * XsdtPointer;
         static acpi_table_madt * MadtPointer;
         static acpi_table_srat * SratPointer;
+        static acpi_table_slit * SlitPointer;
+        static acpi_table_hpet * HpetPointer;
 
 #if   defined(__BEELZEBUB_SETTINGS_SMP)
         static size_t LapicCount;
@@ -142,6 +144,8 @@ namespace Beelzebub { namespace System
 
         static __startup Handle HandleMadt(paddr_t const paddr, SystemDescriptorTableSource const src);
         static __startup Handle HandleSrat(paddr_t const paddr, SystemDescriptorTableSource const src);
+        static __startup Handle HandleSlit(paddr_t const paddr, SystemDescriptorTableSource const src);
+        static __startup Handle HandleHpet(paddr_t const paddr, SystemDescriptorTableSource const src);
 
         /*  Utilities  */
 
@@ -160,5 +164,27 @@ namespace Beelzebub { namespace System
 
     public:
         static __startup Handle FindLapicPaddr(paddr_t & paddr);
+
+        /**
+         *  <summary>
+         *  Finds the proximity domain of the given physical address in the SRAT.
+         *  </summary>
+         *  <param name="end">
+         *  Receives the end of the range which shares the outcome: the end of
+         *  the affinity range on success, otherwise the start of the next one
+         *  (or null if there is none).
+         *  </param>
+         */
+        static Handle GetMemoryAffinity(paddr_t const addr, uint32_t & domain, paddr_t & end);
+        static Handle GetLapicAffinity(uint32_t const apicId, uint32_t & domain);
+
+        /**
+         *  <summary>
+         *  Obtains the relative distance between two proximity domains from
+         *  the SLIT, with 10 meaning local. Falls back to 10 and 20 when the
+         *  distance is unknown.
+         *  </summary>
+         */
+        static uint32_t GetLocalityDistance(uint32_t const from, uint32_t const to);
     };
 }}
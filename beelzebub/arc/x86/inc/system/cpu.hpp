@@ -48,9 +48,11 @@
 #include "execution/thread.hpp"
 
 #include "mailbox.hpp"
+#include "memory/pmm.hpp"
 
 #include <beel/sync/atomic.hpp>
 #include <beel/sync/smp.lock.hpp>
+#include <beel/sync/queue.mpsc.intrusive.hpp>
 
 #define REGFUNC1(regl, regu, type)                                   \
 static __forceinline type MCATS2(Get, regu)()                        \
@@ -127,15 +129,28 @@ namespace Beelzebub { namespace System
 
         Execution::Thread * LastExtendedStateThread = nullptr;
 
+        Memory::SmallFrameMagazine SmallFrames;
+        Memory::LargeFrameMagazine LargeFrames;
+        //  Frames in these are in use as far as the allocation spaces know.
+
+        Memory::NumaNode Node = Memory::NumaNode::Any;
+        //  Magazines are refilled from this node first.
+
+        vaddr_t FrameWindow = nullvaddr;
+        //  Used by the PMM to clear frames; only with interrupts disabled.
+
 #if defined(__BEELZEBUB_SETTINGS_SMP)
-        MailboxEntryBase * MailHead = nullptr, * MailTail = nullptr;
-        Synchronization::SmpLock MailLock {};
+        Synchronization::MpscQueueIntrusive<MailboxEntryLink> MailQueue {};
+        Synchronization::Atomic<bool> MailIpiPending { false };
+        uint32_t LapicLogicalId = 0;
 
 #ifdef __BEELZEBUB_SETTINGS_MANYCORE
         uint64_t MailGeneration = 0;
 #endif
 
-        Synchronization::Atomic<MailboxEntryBase *> MailNmTop { nullptr };
+        Synchronization::Atomic<MailboxEntryLink *> MailNmTop { nullptr };
+        Synchronization::Atomic<MailboxEntryPooled *> MailPoolReturns { nullptr };
+        //  Pooled entries are handed back here by whichever core finishes them.
 #endif
     };
 
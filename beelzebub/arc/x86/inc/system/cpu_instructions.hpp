@@ -99,6 +99,16 @@ namespace Beelzebub { namespace System
             asm volatile ( "clflush %0 \n\t" : : "m"(*p) );
         }
 
+        static __artificial void StoreNonTemporal(uintptr_t * const addr, uintptr_t const val)
+        {
+            asm volatile ( "movnti %1, %0 \n\t" : "=m"(*addr) : "r"(val) );
+        }
+
+        static __artificial void StoreFence()
+        {
+            asm volatile ( "sfence \n\t" : : : "memory" );
+        }
+
         /*  Profiling  */
 
 #if   defined(__BEELZEBUB__ARCH_AMD64)
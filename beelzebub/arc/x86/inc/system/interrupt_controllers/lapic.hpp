@@ -65,6 +65,7 @@ namespace Beelzebub { namespace System { namespace InterruptControllers
         LapicId                      = 0x0002,
         SpuriousInterruptVector      = 0x000F,
         EndOfInterrupt               = 0x000B,
+        LogicalDestination           = 0x000D,
         InterruptCommandRegisterLow  = 0x0030,
         InterruptCommandRegisterHigh = 0x0031,
         TimerLvt                     = 0x0032,
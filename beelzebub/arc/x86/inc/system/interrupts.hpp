@@ -327,6 +327,7 @@ namespace Beelzebub { namespace System
         E(AlignmentCheck             , 17 ) \
         E(MachineCheck               , 18 ) \
         E(SimdFloatingPointException , 19 ) \
+        E(Reschedule                 , 253) \
         E(ApicTimer                  , 254) \
         E(Mailbox                    , 255)
 
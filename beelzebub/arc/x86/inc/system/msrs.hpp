@@ -74,6 +74,8 @@ namespace Beelzebub { namespace System
     {
         //  (L)APIC/x2APIC
         IA32_APIC_BASE      = 0x0000001B,
+        //  TSC Target of Local APIC's TSC Deadline Mode
+        IA32_TSC_DEADLINE   = 0x000006E0,
 
         //  Extended Feature Enables
         IA32_EFER           = 0xC0000080,
@@ -93,6 +95,8 @@ namespace Beelzebub { namespace System
         IA32_GS_BASE        = 0xC0000101,
         //  Swap Target of BASE Adddress of GS
         IA32_KERNEL_GS_BASE = 0xC0000102,
+        //  Auxiliary TSC, returned by RDTSCP
+        IA32_TSC_AUX        = 0xC0000103,
 
         //  Base MSR for x2APIC registers
         IA32_X2APIC_BASE    = 0x00000800,
@@ -81,6 +81,10 @@ namespace Beelzebub { namespace System { namespace Timers
 
         static void Stop();
 
+        static void Deadline(uint8_t interrupt, bool mask = true);
+
+        static void SetDeadline(uint64_t tsc);
+
     private:
         static void SetInternal(uint32_t count, uint8_t interrupt, bool periodic, bool mask = true);
     };
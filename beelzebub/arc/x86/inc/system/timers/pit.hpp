@@ -147,13 +147,12 @@ namespace Beelzebub { namespace System { namespace Timers
         static uint32_t const MinimumFrequency = 19;
 
         static uint32_t Period, Frequency; //  In microseconds.
+        static uint16_t Divider;
 
         /*  IRQ Handler  */
 
         static constexpr irq_t const IrqVector { 0 };
 
-        static void IrqHandler(InterruptContext const * context, void * cookie);
-
         /*  Constructor(s)  */
 
     protected:
@@ -168,5 +167,9 @@ namespace Beelzebub { namespace System { namespace Timers
         static __cold void SetFrequency(uint32_t freq);
 
         static __cold void SendCommand(PitCommand const cmd);
+
+        /*  Operation  */
+
+        static uint16_t ReadCount();
     };
 }}}
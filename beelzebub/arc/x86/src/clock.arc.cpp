@@ -0,0 +1,325 @@
+/*
+    Copyright (c) 2017 Alexandru-Mihai Maftei. All rights reserved.
+
+
+    Developed by: Alexandru-Mihai Maftei
+    aka Vercas
+    http://vercas.com | https://github.com/vercas/Beelzebub
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to
+    deal with the Software without restriction, including without limitation the
+    rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+    sell copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+      * Redistributions of source code must retain the above copyright notice,
+        this list of conditions and the following disclaimers.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimers in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the names of Alexandru-Mihai Maftei, Vercas, nor the names of
+        its contributors may be used to endorse or promote products derived from
+        this Software without specific prior written permission.
+
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+    WITH THE SOFTWARE.
+
+    ---
+
+    You may also find the text of this license in "LICENSE.md", along with a more
+    thorough explanation regarding other files.
+*/
+
+#include "clock.hpp"
+#include "timer.hpp"
+#include "system/timers/apic.timer.hpp"
+#include "system/timers/pit.hpp"
+#include "system/acpi.hpp"
+#include "system/cpuid.hpp"
+#include "system/rtc.hpp"
+#include "system/cpu_instructions.hpp"
+#include "memory/vmm.hpp"
+#include <beel/sync/smp.lock.hpp>
+#include <math.h>
+
+#include <debug.hpp>
+
+using namespace Beelzebub;
+using namespace Beelzebub::Memory;
+using namespace Beelzebub::Synchronization;
+using namespace Beelzebub::System;
+using namespace Beelzebub::System::Timers;
+
+/****************
+    Internals
+****************/
+
+/*
+Every source is read as a free-running count which is turned into microseconds
+with a multiplication and a shift, so that reading the clock costs little more
+than reading the counter. The invariant TSC is preferred because it is read
+without leaving the core; it is assumed to be synchronized across cores.
+The HPET's main counter is read through MMIO. The PIT's counter wraps too often
+to be left alone, so its wraps are accumulated in software, and a timer makes
+sure it is read at least once per period.
+
+The PIT keeps whatever rate it was programmed with, because its interrupts
+also drive Utils::Wait. Counts are in units of the PIT's input clock, so the
+rate only decides how often the counter wraps, and thus how often it must
+be read.
+ */
+
+static constexpr size_t const HpetCapabilities = 0x000;
+static constexpr size_t const HpetConfiguration = 0x010;
+static constexpr size_t const HpetMainCounter = 0x0F0;
+
+static constexpr uint64_t const HpetCounter64Bit = 1ULL << 13;
+static constexpr uint64_t const HpetEnable = 1ULL << 0;
+
+static uint64_t volatile * HpetBase = nullptr;
+
+static SmpLock PitLock {};
+static uint64_t PitAccumulated = 0;
+static uint16_t PitLast = 0;
+
+static __hot __forceinline TimeSpanLite GetPitRefreshInterval()
+{
+    return TimeSpanLite(Pit::Period / 2);
+    //  Along with a quarter of a period of slack, the counter is still read
+    //  less than a period apart.
+}
+
+static __hot uint64_t ReadPit()
+{
+    InterruptGuard<> intGuard;
+    //  A timer interrupt could read the clock while the lock is held.
+
+    withLock (PitLock)
+    {
+        uint16_t const current = Pit::ReadCount();
+
+        PitAccumulated += current <= PitLast
+            ? PitLast - current
+            : PitLast + Pit::Divider - current;
+        //  The counter counts down and reloads with the divider.
+
+        PitLast = current;
+
+        return PitAccumulated;
+    }
+
+    __unreachable_code;
+}
+
+static __hot __forceinline uint64_t ReadCounter()
+{
+    switch (Clock::Source)
+    {
+    case ClockSource::Tsc:
+        return CpuInstructions::Rdtsc();
+
+    case ClockSource::Hpet:
+        return HpetBase[HpetMainCounter / sizeof(uint64_t)];
+
+    case ClockSource::Pit:
+        return ReadPit();
+
+    default:
+        return 0;
+    }
+}
+
+static void RefreshPit(void * cookie)
+{
+    (void)cookie;
+
+    ReadPit();
+
+    ASSERT(Timer::Enqueue(GetPitRefreshInterval(), &RefreshPit, nullptr, nullptr
+        , TimeSpanLite(Pit::Period / 4)));
+}
+
+static __startup Handle InitializeHpet()
+{
+    if (Acpi::HpetPointer == nullptr)
+        return HandleResult::NotFound;
+
+    paddr_t const paddr { Acpi::HpetPointer->Address.Address };
+    vaddr_t vaddr = nullvaddr;
+
+    Handle res = Vmm::AllocatePages(nullptr
+        , vsize_t(PageSize.Value)
+        , MemoryAllocationOptions::Reserve | MemoryAllocationOptions::VirtualKernelHeap
+        , MemoryFlags::Global
+        , MemoryContent::Generic
+        , vaddr);
+
+    if unlikely(!res.IsOkayResult())
+        return res;
+
+    res = Vmm::MapPage(nullptr
+        , vaddr
+        , RoundDown(paddr, PageSize)
+        , MemoryFlags::Global | MemoryFlags::Writable
+        , MemoryMapOptions::NoReferenceCounting);
+
+    if unlikely(!res.IsOkayResult())
+        return res;
+
+    uint64_t volatile * const base = reinterpret_cast<uint64_t volatile *>(
+        vaddr.Value + (paddr.Value & (PageSize.Value - 1)));
+
+    uint64_t const caps = base[HpetCapabilities / sizeof(uint64_t)];
+
+    if ((caps & HpetCounter64Bit) == 0)
+        return HandleResult::UnsupportedOperation;
+    //  A 32-bit main counter would wrap every few minutes.
+
+    uint64_t const period = caps >> 32;   //  Femtoseconds per count.
+
+    if unlikely(period == 0)
+        return HandleResult::IntegrityFailure;
+
+    base[HpetConfiguration / sizeof(uint64_t)] |= HpetEnable;
+
+    HpetBase = base;
+    Clock::Frequency = 1000000000000000ULL / period;
+
+    return HandleResult::Okay;
+}
+
+static __startup void InitializePit()
+{
+    Pit::SendCommand(PitCommand(0)
+        .SetChannel(PitChannel::Channel0)
+        .SetAccessMode(PitAccessMode::LowHigh)
+        .SetOperatingMode(PitOperatingMode::RateGenerator));
+
+    Pit::SetFrequency(Pit::Frequency != 0 ? Pit::Frequency : Pit::MinimumFrequency);
+    //  Changing the mode requires reloading the divider. The current rate is
+    //  kept, or the longest period is used if the PIT was never programmed.
+
+    PitLast = Pit::ReadCount();
+
+    Clock::Frequency = Pit::BaseFrequency;
+}
+
+static __startup Handle InitializeSharedPage()
+{
+    vaddr_t vaddr = nullvaddr;
+
+    Handle res = Vmm::AllocatePages(nullptr
+        , vsize_t(PageSize.Value)
+        , MemoryAllocationOptions::Commit | MemoryAllocationOptions::VirtualKernelHeap
+        , MemoryFlags::Global | MemoryFlags::Writable
+        , MemoryContent::Generic
+        , vaddr);
+
+    if unlikely(!res.IsOkayResult())
+        return res;
+
+    res = Vmm::Translate(nullptr, vaddr, Clock::SharedPagePaddr);
+
+    if unlikely(!res.IsOkayResult())
+        return res;
+
+    Execution::TimePage * const page = reinterpret_cast<Execution::TimePage *>(vaddr.Value);
+
+    page->WriteBegin();
+
+    page->TscClock = Clock::Source == ClockSource::Tsc;
+    page->TscCpuIndex = BootstrapCpuid.CheckFeature(CpuFeature::RDTSP);
+    page->Shift = Clock::Shift;
+    page->Multiplier = Clock::Multiplier;
+    page->Offset = Clock::Offset;
+    page->BootEpoch = Clock::BootEpoch;
+
+    page->WriteEnd();
+
+    Clock::SharedPage = page;
+
+    return HandleResult::Okay;
+}
+
+static __startup uint64_t GetDaysSinceEpoch(uint32_t year, uint32_t month, uint32_t day)
+{
+    year -= month <= 2;
+
+    uint32_t const era = year / 400;
+    uint32_t const yoe = year - era * 400;
+    uint32_t const doy = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    uint32_t const doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+
+    return (uint64_t)era * 146097 + doe - 719468;
+    //  Counted from the 1st of March of year 0, when leap days are last.
+}
+
+/******************
+    Clock class
+******************/
+
+/*  Statics  */
+
+ClockSource Clock::Source = ClockSource::None;
+uint64_t Clock::Frequency = 0;
+
+uint64_t Clock::Multiplier = 0;
+uint8_t Clock::Shift = 40;
+uint64_t Clock::Offset = 0;
+
+uint64_t Clock::BootEpoch = 0;
+
+Execution::TimePage * Clock::SharedPage = nullptr;
+paddr_t Clock::SharedPagePaddr = nullpaddr;
+
+/*  Initialization  */
+
+Handle Clock::Initialize()
+{
+    if unlikely(Source != ClockSource::None)
+        return HandleResult::CardinalityViolation;
+
+    if (BootstrapCpuid.CheckFeature(CpuFeature::InvariantTsc) && ApicTimer::TscFrequency != 0)
+    {
+        Frequency = ApicTimer::TscFrequency;
+        Source = ClockSource::Tsc;
+    }
+    else if (InitializeHpet().IsOkayResult())
+        Source = ClockSource::Hpet;
+    else
+    {
+        InitializePit();
+        Source = ClockSource::Pit;
+    }
+
+    Multiplier = (1000000ULL << Shift) / Frequency;
+    //  The product with the counts is computed on 128 bits.
+
+    Rtc::Read();
+    Offset = ReadCounter();
+
+    BootEpoch = (GetDaysSinceEpoch(Rtc::Year, Rtc::Month, Rtc::Day) * 86400
+        + Rtc::Hours * 3600 + Rtc::Minutes * 60 + Rtc::Seconds) * 1000000ULL;
+
+    if (Source == ClockSource::Pit)
+        ASSERT(Timer::Enqueue(GetPitRefreshInterval(), &RefreshPit, nullptr, nullptr
+            , TimeSpanLite(Pit::Period / 4)));
+
+    return InitializeSharedPage();
+}
+
+/*  Operation  */
+
+TimeInstantLite Clock::Now()
+{
+    uint64_t const counts = ReadCounter() - Offset;
+
+    return TimeInstantLite((uint64_t)(((uint128_t)counts * Multiplier) >> Shift));
+}
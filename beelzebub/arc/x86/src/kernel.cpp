@@ -59,6 +59,8 @@
 #include "execution/extended_states.hpp"
 #include "execution/runtime64.hpp"
 #include "execution.hpp"
+#include "scheduler.hpp"
+#include "clock.hpp"
 
 #include "irqs.hpp"
 #include "system/acpi.hpp"
@@ -491,6 +493,9 @@ static __startup void MainInitializeVirtualMemory()
     InitTerminal->Write("[....] Initializing virtual memory...");
     Handle res = InitializeVirtualMemory();
 
+    if (CMDO_FaultAround.ParsingResult.IsValid())
+        Vmm::FaultAroundPages = (size_t)CMDO_FaultAround.UnsignedIntegerValue;
+
     if (res.IsOkayResult())
     {
         InitTerminal->Write(" remapping APIC tables... ");
@@ -691,6 +696,15 @@ __startup Handle InitializeTimers()
 
     Timer::Initialize();
 
+    Handle res = Clock::Initialize();
+
+    if unlikely(!res.IsOkayResult())
+        return res;
+
+    static char const * const ClockSourceNames[] { "none", "TSC", "HPET", "PIT" };
+
+    InitTerminal->WriteFormat(" Clock: %s...", ClockSourceNames[(size_t)Clock::Source]);
+
     return HandleResult::Okay;
 }
 
@@ -751,6 +765,28 @@ static __startup void MainBootstrapThread()
     Cpu::SetProcess(&BootstrapProcess);
 }
 
+/****************
+    SCHEDULER
+****************/
+
+static __startup void MainInitializeScheduler()
+{
+    //  Preparing the run queues.
+
+    InitTerminal->Write("[....] Initializing scheduler...");
+
+    Handle res = Scheduler::Initialize(true);
+
+    if (res.IsOkayResult())
+        InitTerminal->WriteLine(" Done.\r[OKAY]");
+    else
+    {
+        InitTerminal->WriteFormat(" Fail..? %H\r[FAIL]%n", res);
+
+        FAIL("Failed to initialize the scheduler: %H", res);
+    }
+}
+
 /***********************
     PROCESSING UNITS
 ***********************/
@@ -1228,8 +1264,9 @@ void Beelzebub::Main()
 
     // MSGEX("Test {0} {1} {2} {2} {0} {1} {1} {0:bit}.\n", true, -124, "rada");
 
-    MainInitializePhysicalMemory();
     MainInitializeAcpiTables();
+    MainInitializePhysicalMemory();
+    //  The SRAT is needed to partition physical memory by proximity domain.
     MainInitializeVirtualMemory();
     MainInitializeBootModules();
 
@@ -1256,6 +1293,7 @@ void Beelzebub::Main()
 #endif
 
     MainBootstrapThread();
+    MainInitializeScheduler();
 
     InitializeExecutionData();
 
@@ -1319,8 +1357,15 @@ void Beelzebub::Main()
 
     InitBarrier.Reach();
 
+    Pic::SetMasked(0, true);
+    //  The PIT was only needed for waiting during initialization. From now on,
+    //  cores are only interrupted by their timers when there is work to do.
+
     Scheduling = true;
 
+    Scheduler::Engage();
+    //  The bootstrap thread is scheduled like any other.
+
     Interrupts::Enable();
 
     // MSG_("Stack pointer in Beelzebub::Main post init is %Xp.%n", GetCurrentStackPointer());
@@ -1561,8 +1606,8 @@ void Beelzebub::Main()
     }
 #endif
 
-    //  Allow the CPU to rest.
-    while (true) if (CpuInstructions::CanHalt) CpuInstructions::Halt();
+    Scheduler::Retire();
+    //  The core goes to its idle thread, unless other threads are waiting.
 }
 
 #if   defined(__BEELZEBUB_SETTINGS_SMP)
@@ -1592,6 +1637,9 @@ void Beelzebub::Secondary()
     Cores::Register();
     //  Register the core with the core manager.
 
+    BootstrapProcess.SetActiveCore(Cpu::GetData()->Index, true);
+    //  Now that its index is known.
+
     MSG_("Registered core #%us... %W", Cpu::GetData()->Index);
 
     Lapic::Initialize();
@@ -1633,6 +1681,13 @@ void Beelzebub::Secondary()
 
     MSG_("Initialized mailbox!%n%W");
 
+    Handle res = Scheduler::Initialize(false);
+
+    ASSERT(res.IsOkayResult(), "Failed to initialize scheduler on core #%us: %H."
+        , Cpu::GetData()->Index, res);
+
+    MSG_("Initialized scheduler!%n%W");
+
     // Watchdog::Initialize();
     // //  Sadly needed.
 
@@ -1744,7 +1799,13 @@ void Beelzebub::Secondary()
     }
 #endif
 
-    //  Allow the CPU to rest.
-    while (true) if (CpuInstructions::CanHalt) CpuInstructions::Halt();
+    Scheduler::Engage();
+    //  This context becomes the core's idle thread, which halts until another
+    //  core wakes it up to steal work.
+
+    while (true)
+        if (!Pmm::ReplenishZeroedFrames() && CpuInstructions::CanHalt)
+            CpuInstructions::Halt();
+    //  Idle time goes into clearing frames for demand paging.
 }
 #endif
@@ -39,10 +39,10 @@
 
 #include <keyboard.hpp>
 
-#include <system/cpu.hpp>   //  Only used for task switching right now...
 #include <system/io_ports.hpp>
 #include <system/timers/pit.hpp>
 
+#include <scheduler.hpp>
 #include <kernel.hpp>
 #include <debug.hpp>
 
@@ -114,26 +114,7 @@ void keyboard_handler(INTERRUPT_HANDLER_ARGS)
             break;
 
         case KEYBOARD_CODE_UP:
-            Thread * const activeThread = Cpu::GetThread();
-
-            if (activeThread != nullptr)
-            {
-                // activeThread->State = *state;
-
-                //msg("PRE-SWITCH ");
-                //PrintToDebugTerminal(state);
-                //msg("%n");
-
-                /*msg("(( AT=%Xp; N=%Xp; P=%Xp; BST=%B ))%n"
-                    , activeThread, activeThread->Next, activeThread->Previous
-                    , activeThread == &BootstrapThread);//*/
-
-                activeThread->SwitchToNext(state);
-
-                //msg("%nPOST-SWITCH ");
-                //PrintToDebugTerminal(state);
-                //msg("%n");
-            }
+            Scheduler::Preempt(state);
 
             break;
 
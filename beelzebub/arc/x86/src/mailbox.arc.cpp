@@ -53,6 +53,7 @@ lean & mean implementation without his aid.
 #include "irqs.hpp"
 #include <beel/sync/smp.lock.hpp>
 #include <string.h>
+#include <new>
 
 using namespace Beelzebub;
 using namespace Beelzebub::Synchronization;
@@ -70,6 +71,46 @@ static MailboxEntryBase * GlobalTail = nullptr;
 static size_t GlobalGeneration = 0;
 #endif
 
+/*  Entry Pool  */
+
+static constexpr size_t const PoolCapacity = 64;
+//  Maximum number of pooled entries owned by a single core.
+
+static __thread MailboxEntryPooled * PoolFree;
+static __thread size_t PoolAllocated;
+
+static __hot void ReturnEntry(MailboxEntryPooled * pooled)
+{
+    CpuData * const home = Cores::Get(pooled->HomeCore);
+
+    MailboxEntryPooled * top = home->MailPoolReturns.Load();
+
+    do pooled->PoolNext = top; while (!home->MailPoolReturns.CmpXchgStrong(top, pooled));
+    //  Lock-free, so it is safe even from NMIs. The home core takes the whole
+    //  stack at once, thus there is no ABA problem.
+}
+
+static __hot void CompleteEntry(MailboxEntryBase * entry)
+{
+    MailboxEntryPooled * const pooled = MailboxEntryPooled::FromEntry(entry);
+
+    if (pooled->Completion != nullptr)
+        pooled->Completion(pooled->CompletionCookie);
+
+    ReturnEntry(pooled);
+}
+
+static __hot __forceinline void ReleaseEntry(MailboxEntryBase * entry, bool const pooled)
+{
+    //  `pooled` must be read before the counter is decremented, because an
+    //  entry which is not pooled may be gone right after. Pooled entries are
+    //  only released once their function has run, so the completion really
+    //  comes after all the work.
+
+    if (--entry->DestinationsLeft == 0 && pooled)
+        CompleteEntry(entry);
+}
+
 static __hot void ExecuteNmMail(InterruptContext const * context, void * isrCookie)
 {
     (void)context;
@@ -77,42 +118,41 @@ static __hot void ExecuteNmMail(InterruptContext const * context, void * isrCook
 
     CpuData * const data = Cpu::GetData();
 
-    MailboxEntryBase * entry;
+    MailboxEntryLink * link;
 
-    while ((entry = data->MailNmTop.Xchg(nullptr)) != nullptr)
+    while ((link = data->MailNmTop.Xchg(nullptr)) != nullptr)
         do
         {
+            MailboxEntryBase * const entry = link->Owner;
             MailFunction const func = entry->Function;
             void * const cookie = entry->Cookie;
-            Synchronization::Atomic<unsigned int> * dstCtr = nullptr;
+            bool const pooled = entry->GetPooled();
+            MailboxEntryBase * awaited = nullptr;
 
-            for (unsigned int i = 0; i < entry->DestinationCount; ++i)
-            {
-                MailboxEntryLink & link = entry->Links[i];
-
-                if (link.Core == data->Index)
-                {
-                    if (entry->GetAwait())
-                        dstCtr = &(entry->DestinationsLeft);
-                    else
-                    {
-                        --entry->DestinationsLeft;
-                        //  This core no longer needs anything from that mail entry.
-                    }
-
-                    entry = link.Next;
-                    //  Prepares for the next entry as well.
-
-                    break;
-                }
-            }
+            link = link->Next;
+            //  Prepares for the next entry before this one can be released.
+
+            if (entry->GetAwait() || pooled)
+                awaited = entry;
+            else
+                ReleaseEntry(entry, pooled);
+                //  This core no longer needs anything from that mail entry.
 
             func(cookie);
 
-            if unlikely(dstCtr != nullptr)
-                dstCtr->operator --();
-        } while (entry != nullptr);
+            if (awaited != nullptr)
+                ReleaseEntry(awaited, pooled);
+        } while (link != nullptr);
+}
+
+#ifdef __BEELZEBUB_SETTINGS_MANYCORE
+static __hot inline MailboxEntryBase * GetNextGlobal(MailboxEntryBase const * entry)
+{
+    MailboxEntryLink const * const next = entry->Links[0].Next;
+
+    return next == nullptr ? nullptr : next->Owner;
 }
+#endif
 
 static __hot __solid bool ExecuteHead()
 {
@@ -120,45 +160,31 @@ static __hot __solid bool ExecuteHead()
 
     MailFunction func = nullptr;
     void * cookie = nullptr;
-    Synchronization::Atomic<unsigned int> * dstCtr = nullptr;
+    MailboxEntryBase * awaited = nullptr;
+    bool pooled = false;
 
-    withLock (data->MailLock)
-    {
-        auto head = data->MailHead;
+    MailboxEntryLink * const link = data->MailQueue.Pop();
+    //  This dequeues the mail entry, without any locking.
 
-        if unlikely(head == nullptr)
+    if unlikely(link == nullptr)
 #ifdef __BEELZEBUB_SETTINGS_MANYCORE
-            goto check_global;
+        goto check_global;
 #else
-            return false;
+        return false;
 #endif
 
+    {
+        MailboxEntryBase * const head = link->Owner;
+
         func = head->Function;
         cookie = head->Cookie;
+        pooled = head->GetPooled();
 
-        for (unsigned int i = 0; i < head->DestinationCount; ++i)
-        {
-            MailboxEntryLink & link = head->Links[i];
-
-            if (link.Core == data->Index)
-            {
-                data->MailHead = link.Next;
-                //  This dequeues the mail entry.
-
-                if (head->GetAwait())
-                    dstCtr = &(head->DestinationsLeft);
-                else
-                {
-                    --head->DestinationsLeft;
-                    //  This core no longer needs anything from that mail entry.
-                }
-
-                break;
-            }
-        }
-
-        if (data->MailHead == nullptr)
-            data->MailTail = nullptr;
+        if (head->GetAwait() || pooled)
+            awaited = head;
+        else
+            ReleaseEntry(head, pooled);
+            //  This core no longer needs anything from that mail entry.
     }
 
 #ifdef __BEELZEBUB_SETTINGS_MANYCORE
@@ -186,7 +212,7 @@ check_global:
                 break;
             }
 
-            entry = entry->Links[0].Next;
+            entry = GetNextGlobal(entry);
         }
 
         if (entry == nullptr)
@@ -198,8 +224,8 @@ execute:
 
     func(cookie);
 
-    if unlikely(dstCtr != nullptr)
-        dstCtr->operator --();
+    if (awaited != nullptr)
+        ReleaseEntry(awaited, pooled);
 
     return true;
 }
@@ -209,76 +235,132 @@ static __hot __realign_stack void MailboxIsrHandler(InterruptContext const * con
     (void)context;
     (void)cookie;
 
+    Cpu::GetData()->MailIpiPending.Store(false);
+    //  Cleared before draining, so mail posted without an IPI of its own is
+    //  guaranteed to be seen by this drain.
+
     while (ExecuteHead()) { /* loopie loop */ }
 }
 
-static __hot void PostInternal(MailboxEntryBase * entry, TimeWaster waster, void * cookie, bool poll, bool broadcast)
+/*
+IPIs are coalesced: a core is only interrupted for mail if it does not already
+have a mailbox IPI in flight. In x2APIC mode, targets within the same cluster
+are sent a single multicast IPI through their logical destinations, which covers
+up to 16 cores in one ICR write.
+ */
+
+static __hot void SendMailIpi(uint32_t const destination, bool const logical)
 {
-    for (unsigned int i = 0; i < entry->DestinationCount; ++i)
+    Lapic::SendIpi(LapicIcr(0)
+        .SetDeliveryMode(InterruptDeliveryModes::Fixed)
+        .SetDestinationShorthand(IcrDestinationShorthand::None)
+        .SetDestinationLogical(logical)
+        .SetAssert(true)
+        .SetDestination(destination)
+        .SetVector(KnownIsrs::Mailbox));
+}
+
+static __hot void AddIpiTarget(uint32_t & multicast, CpuData const * const target)
+{
+    if (!Lapic::X2ApicMode)
+        return SendMailIpi(target->LapicId, false);
+
+    uint32_t const logical = target->LapicLogicalId;
+
+    if (multicast != 0 && (multicast >> 16) != (logical >> 16))
     {
-        uint32_t const targetCore = entry->Links[i].Core;
-        CpuData * const target = Cores::Get(targetCore);
+        SendMailIpi(multicast, true);
+        //  Different cluster; the accumulated one is sent off.
 
-        if (entry->GetNonMaskable())
-        {
-            MailboxEntryBase * top = target->MailNmTop.Load();
+        multicast = 0;
+    }
 
-            do entry->Links[i].Next = top; while (!target->MailNmTop.CmpXchgStrong(top, entry));
-        }
-        else
-        {
-            withLock (target->MailLock)
-            {
-                if likely(target->MailTail != nullptr)
-                {
-                    //  Mail is already queued for this core, so the entry is added to the tail.
+    multicast |= logical;
+}
 
-                    MailboxEntryBase * const tail = target->MailTail;
+static __hot void FlushIpiTargets(uint32_t & multicast)
+{
+    if (multicast != 0)
+        SendMailIpi(multicast, true);
 
-                    for (unsigned int j = 0; j < entry->DestinationCount; ++j)
-                    {
-                        MailboxEntryLink & link = tail->Links[j];
+    multicast = 0;
+}
 
-                        if (link.Core == targetCore)
-                        {
-                            link.Next = entry;
+static __hot void DeliverInternal(MailboxEntryBase * entry, bool broadcast)
+{
+    bool const nonMaskable = entry->GetNonMaskable();
 
-                            break;
-                        }
-                    }
+    uint64_t needed = 0;        //  Bitmap of the first 64 links which need an IPI.
+    uint32_t multicast = 0;
+    unsigned int skipped = 0;
+    unsigned int deferred = 64; //  Links in [64, deferred) need an IPI too.
 
-                    target->MailTail = entry;
-                }
-                else
-                    target->MailTail = target->MailHead = entry;    //  ezpz
-            }
-        }
+    for (unsigned int i = 0; i < entry->DestinationCount; ++i)
+    {
+        MailboxEntryLink * const link = entry->Links + i;
+        CpuData * const target = Cores::Get(link->Core);
+
+        link->Owner = entry;
 
-        if unlikely(!broadcast)
+        if (nonMaskable)
         {
-            if (entry->GetNonMaskable())
+            MailboxEntryLink * top = target->MailNmTop.Load();
+
+            do link->Next = top; while (!target->MailNmTop.CmpXchgStrong(top, link));
+
+            if unlikely(!broadcast)
                 Nmi::Send(target->LapicId);
-            else
-                Lapic::SendIpi(LapicIcr(0)
-                    .SetDeliveryMode(InterruptDeliveryModes::Fixed)
-                    .SetDestinationShorthand(IcrDestinationShorthand::None)
-                    .SetAssert(true)
-                    .SetDestination(target->LapicId)
-                    .SetVector(KnownIsrs::Mailbox));
+
+            continue;
         }
+
+        target->MailQueue.Push(link);
+        //  A single atomic exchange; senders do not contend on a lock.
+
+        if (target->MailIpiPending.Xchg(true))
+            ++skipped;
+        //  The target will see this mail when it handles the pending IPI.
+        else if likely(i < 64)
+            needed |= 1ULL << i;
+        else if (broadcast && skipped == 0)
+            deferred = i + 1;
+        //  The shorthand may still cover this one, so it waits to see whether
+        //  any later target is skipped. No link before it was.
+        else
+            AddIpiTarget(multicast, target);
     }
 
-    if likely(broadcast)
+    if (nonMaskable)
     {
-        if (entry->GetNonMaskable())
+        if likely(broadcast)
             Nmi::Broadcast();
-        else
-            Lapic::SendIpi(LapicIcr(0)
-                .SetDeliveryMode(InterruptDeliveryModes::Fixed)
-                .SetDestinationShorthand(IcrDestinationShorthand::AllExcludingSelf)
-                .SetAssert(true)
-                .SetVector(KnownIsrs::Mailbox));
     }
+    else if (broadcast && skipped == 0)
+        Lapic::SendIpi(LapicIcr(0)
+            .SetDeliveryMode(InterruptDeliveryModes::Fixed)
+            .SetDestinationShorthand(IcrDestinationShorthand::AllExcludingSelf)
+            .SetAssert(true)
+            .SetVector(KnownIsrs::Mailbox));
+    else
+    {
+        while (needed != 0)
+        {
+            unsigned int const i = (unsigned int)__builtin_ctzll(needed);
+            needed &= needed - 1;
+
+            AddIpiTarget(multicast, Cores::Get(entry->Links[i].Core));
+        }
+
+        for (unsigned int i = 64; i < deferred; ++i)
+            AddIpiTarget(multicast, Cores::Get(entry->Links[i].Core));
+
+        FlushIpiTargets(multicast);
+    }
+}
+
+static __hot void PostInternal(MailboxEntryBase * entry, TimeWaster waster, void * cookie, bool poll, bool broadcast)
+{
+    DeliverInternal(entry, broadcast);
 
     if (waster != nullptr)
         waster(cookie);
@@ -299,12 +381,14 @@ static __hot void PostGlobal(MailboxEntryBase * entry, TimeWaster waster, void *
         //  This be the generation of the mail entry.
 
         entry->Links[0].Generation = gen;
+        entry->Links[0].Owner = entry;
+        entry->Links[0].Next = nullptr;
 
         if (GlobalTail == nullptr)
             GlobalHead = GlobalTail = entry;
         else
         {
-            GlobalTail->Links[0].Next = entry;
+            GlobalTail->Links[0].Next = entry->Links;
 
             assert(GlobalTail->Links[0].Generation < gen)
                 (GlobalTail->Links[0].Generation)(gen);
@@ -317,7 +401,7 @@ static __hot void PostGlobal(MailboxEntryBase * entry, TimeWaster waster, void *
         .SetDeliveryMode(InterruptDeliveryModes::Fixed)
         .SetDestinationShorthand(IcrDestinationShorthand::AllExcludingSelf)
         .SetAssert(true)
-        .SetVector(KnownIsrs::Mailbox);
+        .SetVector(KnownIsrs::Mailbox));
 
     if (waster != nullptr)
         waster(cookie);
@@ -344,7 +428,7 @@ static __hot void PostGlobal(MailboxEntryBase * entry, TimeWaster waster, void *
         assert(entry == GlobalHead)((void *)entry)((void *)GlobalHead);
         //  If another core dequeued it, it's a huge problem.
 
-        entry = entry->Links[0].Next;
+        entry = GetNextGlobal(entry);
 
         if (entry == nullptr)
             GlobalHead = GlobalTail = nullptr;
@@ -400,6 +484,7 @@ bool Mailbox::IsReady()
 void Mailbox::Post(MailboxEntryBase * entry, TimeWaster waster, void * cookie, bool poll)
 {
     assert(entry != nullptr);
+    assert(!entry->GetPooled(), "Pooled mail entries must be posted asynchronously.");
 
     InterruptGuard<> intGuard;
     //  Everything *has* to be done under a lock guard.
@@ -436,4 +521,83 @@ void Mailbox::Post(MailboxEntryBase * entry, TimeWaster waster, void * cookie, b
         return PostInternal(entry, waster, cookie, poll, false);
 }
 
+MailboxEntryBase * Mailbox::GetLocalEntry(unsigned int destCnt, MailFunction func, void * cookie)
+{
+    assert(destCnt <= Cores::GetCount())(destCnt);
+
+    InterruptGuard<> intGuard;
+    //  Mail functions may take entries too.
+
+    MailboxEntryPooled * pooled = PoolFree;
+
+    if unlikely(pooled == nullptr)
+        pooled = Cpu::GetData()->MailPoolReturns.Xchg(nullptr);
+    //  Reclaims everything that was handed back by other cores.
+
+    if unlikely(pooled == nullptr)
+    {
+        if unlikely(PoolAllocated >= PoolCapacity)
+            return nullptr;
+
+        size_t const size = sizeof(MailboxEntryPooled) + sizeof(MailboxEntryBase)
+                          + Cores::GetCount() * sizeof(MailboxEntryLink);
+
+        pooled = reinterpret_cast<MailboxEntryPooled *>(new (std::nothrow) uint8_t[size]);
+
+        if unlikely(pooled == nullptr)
+            return nullptr;
+
+        pooled->PoolNext = nullptr;
+        pooled->HomeCore = Cpu::GetData()->Index;
+
+        ++PoolAllocated;
+    }
+
+    PoolFree = pooled->PoolNext;
+
+    MailboxEntryBase * const entry = new (pooled->GetEntry()) MailboxEntryBase(destCnt, func, cookie);
+    entry->SetPooled(true);
+
+    return entry;
+}
+
+void Mailbox::PostAsync(MailboxEntryBase * entry, MailFunction completion, void * cookie)
+{
+    assert(entry != nullptr);
+    assert(entry->GetPooled(), "Only pooled mail entries can be posted asynchronously.");
+
+    MailboxEntryPooled * const pooled = MailboxEntryPooled::FromEntry(entry);
+
+    pooled->Completion = completion;
+    pooled->CompletionCookie = cookie;
+
+    InterruptGuard<> intGuard;
+
+    bool broadcast = false;
+
+    if (entry->DestinationCount == 1 && entry->Links[0].Core == Broadcast)
+    {
+        //  Pooled entries have room for a link to every core, so broadcasts
+        //  are expanded in place.
+
+        unsigned int const tgCnt = (unsigned int)Cores::GetCount() - 1;
+        unsigned int const thisCore = Cpu::GetData()->Index;
+
+        entry->DestinationCount = tgCnt;
+
+        for (unsigned int link = 0; link < tgCnt; ++link)
+            entry->Links[link] = MailboxEntryLink((link < thisCore) ? link : (link + 1));
+
+        broadcast = true;
+    }
+
+    entry->DestinationsLeft = entry->DestinationCount + 1;
+    //  The sender holds a reference of its own while delivering, otherwise the
+    //  entry could be recycled before all the IPIs are sent.
+
+    DeliverInternal(entry, broadcast);
+
+    ReleaseEntry(entry, true);
+}
+
 #endif
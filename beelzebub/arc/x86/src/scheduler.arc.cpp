@@ -41,28 +41,261 @@
 
 #include "scheduler.hpp"
 #include "memory/vmm.hpp"
+#include "memory/pmm.hpp"
+#include "execution/thread_init.hpp"
+#include "system/interrupt_controllers/lapic.hpp"
+#include "cores.hpp"
+#include "irqs.hpp"
+#include "kernel.hpp"
+#include "timer.hpp"
+#include <beel/sync/smp.lock.hpp>
+#include <string.h>
 #include <math.h>
 #include <new>
 
 using namespace Beelzebub;
 using namespace Beelzebub::Execution;
 using namespace Beelzebub::Memory;
+using namespace Beelzebub::Synchronization;
+using namespace Beelzebub::System;
+using namespace Beelzebub::System::InterruptControllers;
 
 static size_t MaxProcesses = 4095;
-static size_t MaxThreads = sizeof(tid_t);
+static size_t MaxThreads = (size_t)1 << (8 * sizeof(tid_t));
 static size_t MaxScheduledThreads = 100;
 
 static Process * * Processes;
 static Thread * * Threads;
+static SmpLock ThreadsLock {};
 
 static __thread Thread * * MyThreads;
 static __thread Thread * IdleThread;
 static __thread Thread * ActiveThread;
 
+/****************
+    Internals
+****************/
+
+static TimeSpanLite const TimeSlice { 1000 };
+//  1 ms, which is what the PIT used to preempt at. The slice is only armed
+//  while other threads are waiting for the core, so there is no periodic tick.
+
+/**
+ *  A core's queue of threads ready to run, excluding the active one.
+ *  It is a ring buffer over the core's `MyThreads` array, so the owner only
+ *  touches its own cache lines unless it runs out of work.
+ */
+struct RunQueue
+{
+    SmpLock Lock;
+    Thread * * Threads;
+    size_t volatile Head, Count;
+    bool Engaged;
+    bool volatile Idle;
+} __aligned(64);
+
+static RunQueue * RunQueues;
+static Atomic<size_t> IdleCores {0};
+
+static __thread RunQueue * MyQueue;
+static __thread bool SliceExpired, SliceArmed, Retiring;
+
+static __hot bool PushThread(RunQueue * const q, Thread * const thread)
+{
+    if unlikely(q->Count == MaxScheduledThreads)
+        return false;
+
+    q->Threads[(q->Head + q->Count) % MaxScheduledThreads] = thread;
+    ++q->Count;
+
+    return true;
+}
+
+static __hot Thread * PopThread(RunQueue * const q)
+{
+    if (q->Count == 0)
+        return nullptr;
+
+    Thread * const res = q->Threads[q->Head];
+
+    q->Head = (q->Head + 1) % MaxScheduledThreads;
+    --q->Count;
+
+    return res;
+}
+
+static __hot Thread * StealThread()
+{
+    size_t const count = Cores::GetCount();
+    size_t const self = MyQueue - RunQueues;
+
+    for (size_t i = 1; i < count; ++i)
+    {
+        RunQueue * const victim = RunQueues + (self + i) % count;
+
+        if (victim->Count == 0 || !victim->Engaged)
+            continue;
+        //  Peeking without the lock keeps idle cores off the cache lines of
+        //  cores with nothing to give away.
+
+        if (!victim->Lock.TryAcquire())
+            continue;
+        //  A contended queue is being used by its owner; try another one.
+
+        Thread * res = nullptr;
+
+        if (victim->Count > 0)
+        {
+            //  The most recently queued thread is taken, leaving the owner's
+            //  order untouched.
+
+            --victim->Count;
+            res = victim->Threads[(victim->Head + victim->Count) % MaxScheduledThreads];
+        }
+
+        victim->Lock.Release();
+
+        if (res != nullptr)
+            return res;
+    }
+
+    return nullptr;
+}
+
+static void TimeSliceExpired(void *)
+{
+    SliceArmed = false;
+    SliceExpired = true;
+}
+
+static __hot void ArmTimeSlice()
+{
+    if (!SliceArmed)
+        SliceArmed = Timer::Enqueue(TimeSlice, &TimeSliceExpired);
+}
+
+static void SendReschedule(size_t const index)
+{
+    if (index == Cpu::GetData()->Index)
+        Lapic::SendIpi(LapicIcr(0)
+            .SetDeliveryMode(InterruptDeliveryModes::Fixed)
+            .SetDestinationShorthand(IcrDestinationShorthand::Self)
+            .SetAssert(true)
+            .SetVector(KnownIsrs::Reschedule));
+    else
+        Lapic::SendIpi(LapicIcr(0)
+            .SetDeliveryMode(InterruptDeliveryModes::Fixed)
+            .SetDestinationShorthand(IcrDestinationShorthand::None)
+            .SetAssert(true)
+            .SetDestination(Cores::Get(index)->LapicId)
+            .SetVector(KnownIsrs::Reschedule));
+}
+
+static void WakeIdleCore()
+{
+    if (IdleCores.Load() == 0)
+        return;
+
+    size_t const count = Cores::GetCount();
+    size_t const self = MyQueue - RunQueues;
+
+    for (size_t i = 1; i < count; ++i)
+    {
+        size_t const index = (self + i) % count;
+
+        if (RunQueues[index].Idle && RunQueues[index].Engaged)
+            return SendReschedule(index);
+        //  One core is enough; it will steal the thread that was just queued.
+    }
+}
+
+static __hot void SchedulerIrqHandler(InterruptContext const * context, void * cookie)
+{
+    (void)cookie;
+
+    if (!SliceExpired)
+        return;
+
+    SliceExpired = false;
+
+    Scheduler::Preempt(context->Registers);
+}
+
+static __hot void RescheduleIsrHandler(InterruptContext const * context, void * cookie)
+{
+    (void)cookie;
+
+    if (ActiveThread == IdleThread || Retiring)
+        Scheduler::Preempt(context->Registers);
+    //  Busy cores will get to their queued threads when their slice ends.
+}
+
+static __cold void * IdleThreadCode(void *)
+{
+    while (true)
+        if (!Pmm::ReplenishZeroedFrames() && CpuInstructions::CanHalt)
+            CpuInstructions::Halt();
+    //  Idle time goes into clearing frames for demand paging.
+    //  Any interrupt which gives this core work will switch away from here.
+}
+
+static __cold tid_t RegisterThread(Thread * const thread)
+{
+    withLock (ThreadsLock)
+        for (size_t i = 1; i < MaxThreads; ++i)
+            if (Threads[i] == nullptr)
+            {
+                Threads[i] = thread;
+
+                return (tid_t)i;
+            }
+
+    return 0;
+}
+
+static __cold Thread * CreateIdleThread()
+{
+    vaddr_t stack = nullvaddr;
+
+    Handle res = Vmm::AllocatePages(nullptr
+        , vsize_t(CpuStackSize)
+        , MemoryAllocationOptions::Commit   | MemoryAllocationOptions::VirtualKernelHeap
+        | MemoryAllocationOptions::GuardLow | MemoryAllocationOptions::GuardHigh
+        , MemoryFlags::Global | MemoryFlags::Writable
+        , MemoryContent::ThreadStack
+        , stack);
+
+    ASSERT(res.IsOkayResult()
+        , "Failed to allocate stack for idle thread of core #%us: %H."
+        , Cpu::GetData()->Index, res);
+
+    Thread * const res2 = new (std::nothrow) Thread(&BootstrapProcess);
+
+    ASSERT(res2 != nullptr, "Failed to allocate idle thread for core #%us."
+        , Cpu::GetData()->Index);
+
+    res2->KernelStackTop = stack.Value + CpuStackSize;
+    res2->KernelStackBottom = stack.Value;
+    res2->EntryPoint = &IdleThreadCode;
+
+    InitializeThreadState(res2);
+
+    return res2;
+}
+
+static InterruptHandlerNode ApicTimerNode { &SchedulerIrqHandler, nullptr, Irqs::LowPriority };
+static InterruptHandlerNode RescheduleNode { &RescheduleIsrHandler };
+static SmpLock InitLock {};
+static bool Initialized = false;
+
 /**********************
     Scheduler class
 **********************/
 
+/*  Statics  */
+
+__thread tid_t Scheduler::IdleTid = 0;
+
 /*  Initialization  */
 
 Handle Scheduler::Initialize(bool bsp)
@@ -125,6 +358,25 @@ Handle Scheduler::Initialize(bool bsp)
             if (Threads == nullptr)
                 return HandleResult::OutOfMemory;
         }
+
+        memset(Threads, 0, MaxThreads * SizeOf<Thread *>);
+        //  Free thread IDs are found by looking for null entries.
+    }
+
+    withLock (InitLock)
+    {
+        if (!Initialized)
+        {
+            RunQueues = new (std::nothrow) RunQueue[Cores::GetCount()];
+
+            if (RunQueues == nullptr)
+                return HandleResult::OutOfMemory;
+
+            ASSERT(RescheduleNode.Subscribe(Irqs::Reschedule) == IrqSubscribeResult::Success);
+            ASSERT(Lapic::Ender.Register(Irqs::Reschedule) == IrqEnderRegisterResult::Success);
+
+            Initialized = true;
+        }
     }
 
     MyThreads = new (std::nothrow) Thread*[MaxScheduledThreads];
@@ -132,12 +384,168 @@ Handle Scheduler::Initialize(bool bsp)
     if (MyThreads == nullptr)
         return HandleResult::OutOfMemory;
 
+    MyQueue = RunQueues + Cpu::GetData()->Index;
+    MyQueue->Threads = MyThreads;
+    MyQueue->Head = MyQueue->Count = 0;
+    MyQueue->Engaged = false;
+    MyQueue->Idle = false;
+
+    SliceExpired = SliceArmed = Retiring = false;
+
     return HandleResult::Okay;
 }
 
 void Scheduler::Engage()
 {
+    InterruptGuard<> intGuard;
+
+    ActiveThread = Cpu::GetThread();
+
+    if (ActiveThread == nullptr)
+    {
+        //  This core has no thread of its own, so its current execution
+        //  context, which only halts, becomes the idle thread.
+
+        IdleThread = new (std::nothrow) Thread(&BootstrapProcess);
+
+        ASSERT(IdleThread != nullptr, "Failed to allocate idle thread for core #%us."
+            , Cpu::GetData()->Index);
+
+        IdleThread->KernelStackTop = RoundUp(GetCurrentStackPointer(), PageSize.Value);
+        IdleThread->KernelStackBottom = IdleThread->KernelStackTop - CpuStackSize;
+
+        Cpu::SetThread(IdleThread);
+        Cpu::SetProcess(&BootstrapProcess);
+
+        ActiveThread = IdleThread;
+        MyQueue->Idle = true;
+        ++IdleCores;
+    }
+    else
+        IdleThread = CreateIdleThread();
+    //  Otherwise the current thread keeps running, and the idle thread only
+    //  gets the core when there is nothing else to run.
+
+    IdleTid = RegisterThread(IdleThread);
+
+    withLock (InitLock)
+        if (!ApicTimerNode.IsSubscribed())
+            ASSERT(ApicTimerNode.Subscribe(Irqs::ApicTimer) == IrqSubscribeResult::Success);
+
+    MyQueue->Engaged = true;
+
+    if (MyQueue->Count > 0)
+        ArmTimeSlice();
+}
+
+/*  Operation  */
+
+Handle Scheduler::Enqueue(Thread * const thread)
+{
+    if unlikely(thread == nullptr)
+        return HandleResult::ArgumentNull;
+
+    InterruptGuard<> intGuard;
+
+    withLock (MyQueue->Lock)
+        if unlikely(!PushThread(MyQueue, thread))
+            return HandleResult::CardinalityViolation;
+
+    if unlikely(!MyQueue->Engaged)
+        return HandleResult::Okay;
+    //  Engaging will take care of it.
+
+    if (ActiveThread == IdleThread)
+        SendReschedule(MyQueue - RunQueues);
+    else
+    {
+        ArmTimeSlice();
+        //  The active thread now has to share the core.
+
+        WakeIdleCore();
+    }
+
+    return HandleResult::Okay;
+}
+
+void Scheduler::Preempt(GeneralRegisters64 * const state)
+{
+    //  Interrupts are expected to be disabled here.
+
+    if unlikely(!Scheduling || MyQueue == nullptr || !MyQueue->Engaged)
+        return;
+
+    Thread * const current = ActiveThread;
+    bool const stays = current != IdleThread && !Retiring;
+    Thread * next;
+
+    withLock (MyQueue->Lock)
+        next = PopThread(MyQueue);
+
+    if (next == nullptr)
+    {
+        if (stays)
+            return;
+        //  Only cores without a thread of their own go looking for work
+        //  elsewhere. Either way, the timer is left disarmed because nothing
+        //  else is waiting for this core.
 
+        next = StealThread();
+
+        if (next == nullptr)
+        {
+            if (current == IdleThread)
+                return;
+
+            next = IdleThread;
+            //  The retiring thread leaves the core with nothing to run.
+        }
+    }
+
+    if (current == IdleThread)
+    {
+        MyQueue->Idle = false;
+        --IdleCores;
+    }
+    else if (next == IdleThread)
+    {
+        MyQueue->Idle = true;
+        ++IdleCores;
+    }
+
+    Retiring = false;
+
+    if (stays || MyQueue->Count > 0)
+        ArmTimeSlice();
+
+    Handle const res = current->SwitchTo(next, state);
+
+    ASSERT(res.IsOkayResult(), "Failed to switch from thread %Xp to %Xp: %H."
+        , current, next, res);
+
+    ActiveThread = next;
+
+    if (stays)
+        withLock (MyQueue->Lock)
+            PushThread(MyQueue, current);
+    //  Only queued once its registers are saved, otherwise another core could
+    //  steal it and resume it from a stale state. There's room for it because
+    //  a thread was just popped, and only this core pushes onto its queue.
+    //  The idle thread is never queued.
+}
+
+void Scheduler::Retire()
+{
+    withInterrupts (false)
+    {
+        Retiring = true;
+
+        SendReschedule(MyQueue - RunQueues);
+    }
+    //  The core switches away as soon as interrupts are enabled.
+
+    while (true) if (CpuInstructions::CanHalt) CpuInstructions::Halt();
+    //  Only reached again if scheduling is off.
 }
 
 /*  Properties  */
@@ -156,3 +564,13 @@ size_t Scheduler::GetMaximumScheduledThreads()
 {
     return MaxScheduledThreads;
 }
+
+size_t Scheduler::GetIdleCores()
+{
+    return IdleCores.Load();
+}
+
+size_t Scheduler::GetTotalCores()
+{
+    return Cores::GetCount();
+}
@@ -61,6 +61,12 @@ SystemDescriptorTableSource MadtSrc   = SystemDescriptorTableSource::None;
 paddr_t                     SratPaddr = nullpaddr;
 SystemDescriptorTableSource SratSrc   = SystemDescriptorTableSource::None;
 
+paddr_t                     SlitPaddr = nullpaddr;
+SystemDescriptorTableSource SlitSrc   = SystemDescriptorTableSource::None;
+
+paddr_t                     HpetPaddr = nullpaddr;
+SystemDescriptorTableSource HpetSrc   = SystemDescriptorTableSource::None;
+
 /*****************
     ACPI class
 *****************/
@@ -72,6 +78,8 @@ acpi_table_rsdt * Acpi::RsdtPointer = nullptr;
 acpi_table_xsdt * Acpi::XsdtPointer = nullptr;
 acpi_table_madt * Acpi::MadtPointer = nullptr;
 acpi_table_srat * Acpi::SratPointer = nullptr;
+acpi_table_slit * Acpi::SlitPointer = nullptr;
+acpi_table_hpet * Acpi::HpetPointer = nullptr;
 
 size_t Acpi::LapicCount = 0;
 size_t Acpi::PresentLapicCount = 0;
@@ -166,12 +174,14 @@ Handle Acpi::Remap()
     RsdpPointer = RsdpPtr(reinterpret_cast<acpi_table_rsdp *>(reinterpret_cast<uintptr_t>(RsdpPointer.GetInvariantValue()) + VmmArc::IsaDmaStart));
 
     #define REMAP(ptr) \
-    ptr = reinterpret_cast<decltype(ptr)>(reinterpret_cast<uintptr_t>(ptr) - RangeBottom.Value + VirtualBase.Value);
+    if (ptr != nullptr) ptr = reinterpret_cast<decltype(ptr)>(reinterpret_cast<uintptr_t>(ptr) - RangeBottom.Value + VirtualBase.Value);
 
     REMAP(RsdtPointer)
     REMAP(XsdtPointer)
     REMAP(MadtPointer)
     REMAP(SratPointer)
+    REMAP(SlitPointer)
+    REMAP(HpetPointer)
 
     #undef REMAP
 
@@ -416,6 +426,10 @@ Handle Acpi::HandleSystemDescriptorTable(paddr_t const paddr, SystemDescriptorTa
         return Acpi::HandleMadt(paddr, src);
     else if (::memeq(headerPtr->Signature, ACPI_SIG_SRAT, ACPI_NAME_SIZE))
         return Acpi::HandleSrat(paddr, src);
+    else if (::memeq(headerPtr->Signature, ACPI_SIG_SLIT, ACPI_NAME_SIZE))
+        return Acpi::HandleSlit(paddr, src);
+    else if (::memeq(headerPtr->Signature, ACPI_SIG_HPET, ACPI_NAME_SIZE))
+        return Acpi::HandleHpet(paddr, src);
     // else
     //     MSG("$ Found unknown ACPI table: %S%n", ACPI_NAME_SIZE, headerPtr->Signature);
 
@@ -506,6 +520,46 @@ Handle Acpi::HandleSrat(paddr_t const paddr, SystemDescriptorTableSource const s
     return HandleResult::Okay;
 }
 
+Handle Acpi::HandleSlit(paddr_t const paddr, SystemDescriptorTableSource const src)
+{
+    if (SlitPaddr == paddr || (SlitSrc != src && SlitSrc != SystemDescriptorTableSource::None))
+        return HandleResult::Okay;
+    //  Same physical address or different source table? No problemo, then.
+
+    assert_or(SlitPointer == nullptr
+        , "Duplicate (different) SLITs found under the same table (%s)?!%n"
+          "First @ %Xp (%XP);%n"
+          "Second @ %XP."
+        , (src == SystemDescriptorTableSource::Xsdt) ? ACPI_SIG_XSDT : ACPI_SIG_RSDT
+        , SlitPointer, SlitPaddr, paddr)
+    {
+        return HandleResult::CardinalityViolation;
+    }
+
+    SlitPointer = (acpi_table_slit *)(uintptr_t)paddr;
+    SlitPaddr = paddr;
+    SlitSrc = src;
+
+    return HandleResult::Okay;
+}
+
+Handle Acpi::HandleHpet(paddr_t const paddr, SystemDescriptorTableSource const src)
+{
+    if (HpetPaddr == paddr || (HpetSrc != src && HpetSrc != SystemDescriptorTableSource::None))
+        return HandleResult::Okay;
+    //  Same physical address or different source table? No problemo, then.
+
+    if (HpetPointer != nullptr)
+        return HandleResult::Okay;
+    //  Only the first timer block is of any use.
+
+    HpetPointer = (acpi_table_hpet *)(uintptr_t)paddr;
+    HpetPaddr = paddr;
+    HpetSrc = src;
+
+    return HandleResult::Okay;
+}
+
 /*  Utilities  */
 
 Handle Acpi::FindLapicPaddr(paddr_t & paddr)
@@ -521,3 +575,94 @@ Handle Acpi::FindLapicPaddr(paddr_t & paddr)
 
     return HandleResult::Okay;
 }
+
+Handle Acpi::GetMemoryAffinity(paddr_t const addr, uint32_t & domain, paddr_t & end)
+{
+    end = nullpaddr;
+
+    if (SratPointer == nullptr)
+        return HandleResult::UnsupportedOperation;
+
+    uintptr_t const sratEnd = (uintptr_t)SratPointer + SratPointer->Header.Length;
+    uintptr_t e = (uintptr_t)SratPointer + sizeof(*SratPointer);
+
+    for (/* nothing */; e < sratEnd; e += ((acpi_subtable_header *)e)->Length)
+    {
+        if (((acpi_subtable_header *)e)->Type != ACPI_SRAT_TYPE_MEMORY_AFFINITY)
+            continue;
+
+        auto mem = (acpi_srat_mem_affinity *)e;
+
+        if (0 == (mem->Flags & ACPI_SRAT_MEM_ENABLED) || mem->Length == 0)
+            continue;
+
+        paddr_t const start { mem->BaseAddress };
+        paddr_t const rangeEnd { mem->BaseAddress + mem->Length };
+
+        if (addr >= start && addr < rangeEnd)
+        {
+            domain = mem->ProximityDomain;
+            end = rangeEnd;
+
+            return HandleResult::Okay;
+        }
+
+        if (start > addr && (end == nullpaddr || start < end))
+            end = start;
+        //  Closest range above the address.
+    }
+
+    return HandleResult::NotFound;
+}
+
+Handle Acpi::GetLapicAffinity(uint32_t const apicId, uint32_t & domain)
+{
+    if (SratPointer == nullptr)
+        return HandleResult::UnsupportedOperation;
+
+    uintptr_t const sratEnd = (uintptr_t)SratPointer + SratPointer->Header.Length;
+    uintptr_t e = (uintptr_t)SratPointer + sizeof(*SratPointer);
+
+    for (/* nothing */; e < sratEnd; e += ((acpi_subtable_header *)e)->Length)
+    {
+        switch (((acpi_subtable_header *)e)->Type)
+        {
+        case ACPI_SRAT_TYPE_CPU_AFFINITY:
+            {
+                auto cpu = (acpi_srat_cpu_affinity *)e;
+
+                if (0 == (cpu->Flags & ACPI_SRAT_CPU_USE_AFFINITY) || cpu->ApicId != apicId)
+                    break;
+
+                domain = (uint32_t)cpu->ProximityDomainLo
+                       | ((uint32_t)cpu->ProximityDomainHi[0] << 8)
+                       | ((uint32_t)cpu->ProximityDomainHi[1] << 16)
+                       | ((uint32_t)cpu->ProximityDomainHi[2] << 24);
+
+                return HandleResult::Okay;
+            }
+
+        case ACPI_SRAT_TYPE_X2APIC_CPU_AFFINITY:
+            {
+                auto cpu = (acpi_srat_x2apic_cpu_affinity *)e;
+
+                if (0 == (cpu->Flags & ACPI_SRAT_CPU_ENABLED) || cpu->ApicId != apicId)
+                    break;
+
+                domain = cpu->ProximityDomain;
+
+                return HandleResult::Okay;
+            }
+        }
+    }
+
+    return HandleResult::NotFound;
+}
+
+uint32_t Acpi::GetLocalityDistance(uint32_t const from, uint32_t const to)
+{
+    if (SlitPointer != nullptr && from < SlitPointer->LocalityCount && to < SlitPointer->LocalityCount)
+        return SlitPointer->Entry[from * SlitPointer->LocalityCount + to];
+
+    return from == to ? 10 : 20;
+}
@@ -38,6 +38,7 @@
 */
 
 #include "system/interrupt_controllers/lapic.hpp"
+#include "system/acpi.hpp"
 
 #if defined(__BEELZEBUB_SETTINGS_APIC_MODE_FLEXIBLE)
 #include "system/cpu.hpp"
@@ -136,6 +137,19 @@ Handle Lapic::Initialize()
 
     Cpu::GetData()->LapicId = GetId();
 
+    uint32_t domain;
+
+    if (Acpi::GetLapicAffinity(Cpu::GetData()->LapicId, domain).IsOkayResult())
+        Cpu::GetData()->Node = (Memory::NumaNode)domain;
+    //  Without an SRAT, the core prefers no node.
+
+#if defined(__BEELZEBUB_SETTINGS_SMP)
+    if (X2ApicMode)
+        Cpu::GetData()->LapicLogicalId = ReadRegister(LapicRegister::LogicalDestination);
+    //  In x2APIC mode, this is derived from the ID and read-only: the cluster
+    //  in the upper half, and one bit in the lower half.
+#endif
+
     return HandleResult::Okay;
 }
 
@@ -265,6 +265,26 @@ void ApicTimer::Stop()
     Lapic::WriteRegister(LapicRegister::TimerInitialCount, 0);
 }
 
+void ApicTimer::Deadline(uint8_t interrupt, bool mask)
+{
+    Lapic::WriteTimerLvt(ApicTimerLvt(0)
+        .SetVector(interrupt)
+        .SetMode(ApicTimerMode::TscDeadline)
+        .SetMask(mask));
+
+    asm volatile ( "mfence \n\t" : : : "memory" );
+    //  The LVT write must be ordered before any write to the deadline MSR,
+    //  which is not serializing in x2APIC mode.
+
+    Msrs::Write(Msr::IA32_TSC_DEADLINE, (uint64_t)0);
+}
+
+void ApicTimer::SetDeadline(uint64_t tsc)
+{
+    Msrs::Write(Msr::IA32_TSC_DEADLINE, tsc);
+    //  Zero disarms the timer. A deadline in the past fires immediately.
+}
+
 void ApicTimer::SetInternal(uint32_t count, uint8_t interrupt, bool periodic, bool mask)
 {
     Lapic::WriteTimerLvt(ApicTimerLvt(0)
@@ -40,13 +40,10 @@
 #include <system/timers/pit.hpp>
 #include <system/interrupt_controllers/pic.hpp>
 #include <system/io_ports.hpp>
-#include <system/cpu.hpp>   //  Only used for task switching right now...
-#include <kernel.hpp>
     
 #include <debug.hpp>
 
 using namespace Beelzebub;
-using namespace Beelzebub::Execution;
 using namespace Beelzebub::System::InterruptControllers;
 using namespace Beelzebub::Synchronization;
 using namespace Beelzebub::System;
@@ -94,40 +91,7 @@ static inline DividerFrequency GetRealFrequency(uint32_t freq)
 
 uint32_t Pit::Period {0};
 uint32_t Pit::Frequency {0};
-
-/*  IRQ Handler  */
-
-void Pit::IrqHandler(InterruptContext const * context, void * cookie)
-{
-    (void)cookie;
-
-    if (CpuDataSetUp && Scheduling)
-    {
-        Thread * const activeThread = Cpu::GetThread();
-
-        if (activeThread != nullptr && activeThread->Next != activeThread)
-        {
-            // activeThread->State.GeneralRegisters = *state;
-
-            // if (activeThread == &BootstrapThread)
-            //     msg("(( RIP = %Xp ))", state->RIP);
-
-            // msg("PRE-SWITCH ");
-            // PrintToDebugTerminal(state);
-            // msg("%n");
-
-            // msg("(( AT=%Xp; N=%Xp; P=%Xp; BST=%B ))%n"
-            //     , activeThread, activeThread->Next, activeThread->Previous
-            //     , activeThread == &BootstrapThread);
-
-            activeThread->SwitchToNext(context->Registers);
-
-            // msg("%nPOST-SWITCH ");
-            // PrintToDebugTerminal(state);
-            // msg("%n");
-        }
-    }
-}
+uint16_t Pit::Divider {0};
 
 /*  Initialization  */
 
@@ -138,6 +102,7 @@ void Pit::SetFrequency(uint32_t freq)
 
     DividerFrequency divfreq = GetRealFrequency(freq);
     Frequency = freq = divfreq.Frequency;
+    Divider = divfreq.Divider;
 
     Period = 1000000 / freq;
     //  Microseconds.
@@ -150,3 +115,16 @@ void Pit::SendCommand(PitCommand const cmd)
 {
     Io::Out8(0x43, cmd.Value);
 }
+
+/*  Operation  */
+
+uint16_t Pit::ReadCount()
+{
+    SendCommand(PitCommand(0).SetChannel(PitChannel::Channel0).SetAccessMode(PitAccessMode::LatchCountValue));
+
+    uint16_t const low = Io::In8(0x40);
+    uint16_t const high = Io::In8(0x40);
+    //  Latching makes the two bytes consistent.
+
+    return low | (high << 8);
+}
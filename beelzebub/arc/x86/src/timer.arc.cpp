@@ -42,8 +42,11 @@
 #include "system/timers/apic.timer.hpp"
 #include "system/interrupt_controllers/lapic.hpp"
 #include "system/cpuid.hpp"
+#include "system/cpu.hpp"
+#include "mailbox.hpp"
 #include <beel/sync/smp.lock.hpp>
-#include <string.h>
+#include <math.h>
+#include <new>
 
 #include <debug.hpp>
 
@@ -59,50 +62,388 @@ using namespace Beelzebub::System::Timers;
 
 struct TimerEntry
 {
+    TimerEntry * Previous, * Next;
+    uint64_t Deadline;
     TimedFunctionVoid Function;
     void * Cookie;
-    uint32_t Time;
+    uint32_t Generation;
+    uint8_t Level, Slot;
 };
 
-static __thread uint_fast16_t MyTimersCount = 0;
-static __thread TimerEntry MyTimers[Timer::Count];
+/*
+The timers of each core are kept in a hierarchical timing wheel. Every level
+covers 6 bits of the deadline, and an entry is placed on the level of the most
+significant bit in which its deadline differs from the wheel's time. This means
+an entry's slot is always ahead of the wheel's current slot on that level, so
+insertion and removal are constant-time list operations, and the next event is
+found through the lowest non-empty level's bitmap. When the wheel reaches a slot
+on a higher level, its entries cascade down (or expire).
+
+Deadlines are absolute TSC counts, which can be handed straight to the APIC
+timer in TSC-deadline mode.
+
+Every slot also remembers the earliest deadline inserted into it since it was
+last emptied, and the APIC timer is armed for that rather than for the slot's
+start. Cascades therefore happen while handling the interrupt of the earliest
+timer instead of needing interrupts of their own. Removals leave the figure
+alone, so it can only be early, which costs a spurious interrupt at worst.
+
+An entry's generation is bumped whenever it leaves the wheel, which is what
+makes handles to expired or cancelled timers stale. Slack is spent on rounding
+the deadline up to the coarsest power-of-two boundary it allows, so timers with
+similar deadlines end up sharing the same event.
+ */
+
+static constexpr size_t const WheelLevelBits = 6;
+static constexpr size_t const WheelSlots = (size_t)1 << WheelLevelBits;
+static constexpr size_t const WheelLevels = (64 + WheelLevelBits - 1) / WheelLevelBits;
+static constexpr size_t const EntriesPerChunk = 32;
+
+static constexpr uint64_t const NoDeadline = ~0ULL;
+
+struct TimerWheel
+{
+    uint64_t Time;
+    uint64_t Armed;
+    uint64_t Pending[WheelLevels];
+    TimerEntry * Slots[WheelLevels][WheelSlots];
+    uint64_t Earliest[WheelLevels][WheelSlots];
+    TimerEntry * FreeEntries;
+};
+
+static __thread TimerWheel MyWheel;
+
+static __hot __forceinline uint64_t GetNow()
+{
+    return CpuInstructions::Rdtsc();
+}
+
+static __hot TimerEntry * AllocateEntry()
+{
+    TimerEntry * res = MyWheel.FreeEntries;
+
+    if unlikely(res == nullptr)
+    {
+        TimerEntry * const chunk = new (std::nothrow) TimerEntry[EntriesPerChunk]();
+
+        if unlikely(chunk == nullptr)
+            return nullptr;
+
+        for (size_t i = 1; i < EntriesPerChunk - 1; ++i)
+            chunk[i].Next = chunk + i + 1;
+
+        chunk[EntriesPerChunk - 1].Next = nullptr;
+
+        MyWheel.FreeEntries = chunk + 1;
+
+        return chunk;
+        //  Chunks are never returned; the free list only grows to the highest
+        //  number of timers pending on this core at once.
+    }
+
+    MyWheel.FreeEntries = res->Next;
+
+    return res;
+}
+
+static __hot void FreeEntry(TimerEntry * const entry)
+{
+    entry->Next = MyWheel.FreeEntries;
+    MyWheel.FreeEntries = entry;
+}
+
+static __hot void InsertEntry(TimerEntry * const entry)
+{
+    //  The deadline must be past the wheel's time.
+
+    uint64_t const deadline = entry->Deadline;
+    size_t const level = FastLog2(deadline ^ MyWheel.Time) / WheelLevelBits;
+    size_t const slot = (deadline >> (level * WheelLevelBits)) & (WheelSlots - 1);
+
+    TimerEntry * const head = MyWheel.Slots[level][slot];
+
+    entry->Previous = nullptr;
+    entry->Next = head;
+
+    if (head != nullptr)
+    {
+        head->Previous = entry;
+
+        if (deadline < MyWheel.Earliest[level][slot])
+            MyWheel.Earliest[level][slot] = deadline;
+    }
+    else
+        MyWheel.Earliest[level][slot] = deadline;
+
+    MyWheel.Slots[level][slot] = entry;
+    MyWheel.Pending[level] |= 1ULL << slot;
+
+    entry->Level = (uint8_t)level;
+    entry->Slot = (uint8_t)slot;
+}
+
+static __hot void RemoveEntry(TimerEntry * const entry)
+{
+    size_t const level = entry->Level, slot = entry->Slot;
+
+    if (entry->Previous != nullptr)
+        entry->Previous->Next = entry->Next;
+    else if ((MyWheel.Slots[level][slot] = entry->Next) == nullptr)
+        MyWheel.Pending[level] &= ~(1ULL << slot);
+
+    if (entry->Next != nullptr)
+        entry->Next->Previous = entry->Previous;
+}
+
+static __hot uint64_t GetNextEvent()
+{
+    //  Lower levels always have earlier events than higher levels.
+
+    for (size_t level = 0; level < WheelLevels; ++level)
+    {
+        uint64_t const pending = MyWheel.Pending[level];
+
+        if (pending == 0)
+            continue;
+
+        size_t const shift = level * WheelLevelBits;
+        size_t const upper = shift + WheelLevelBits;
+        uint64_t const slot = (uint64_t)__builtin_ctzll(pending);
+
+        uint64_t const base = upper >= 64 ? 0 : (MyWheel.Time & ~((1ULL << upper) - 1));
+
+        return base | (slot << shift);
+    }
+
+    return NoDeadline;
+}
+
+static __hot uint64_t GetNextDeadline()
+{
+    //  The earliest event sits in the first pending slot of the lowest
+    //  non-empty level, same as above.
+
+    for (size_t level = 0; level < WheelLevels; ++level)
+    {
+        uint64_t const pending = MyWheel.Pending[level];
+
+        if (pending != 0)
+            return MyWheel.Earliest[level][__builtin_ctzll(pending)];
+    }
+
+    return NoDeadline;
+}
+
+static __hot TimerEntry * AdvanceWheel(uint64_t const now)
+{
+    TimerEntry * expired = nullptr;
+
+    while (true)
+    {
+        uint64_t const event = GetNextEvent();
+
+        if (event > now)
+            break;
+
+        MyWheel.Time = event;
+
+        size_t level = 0;
+
+        while (MyWheel.Pending[level] == 0)
+            ++level;
+        //  The event came from the lowest non-empty level.
+
+        size_t const slot = (event >> (level * WheelLevelBits)) & (WheelSlots - 1);
+
+        TimerEntry * entry = MyWheel.Slots[level][slot];
+
+        MyWheel.Slots[level][slot] = nullptr;
+        MyWheel.Pending[level] &= ~(1ULL << slot);
+
+        while (entry != nullptr)
+        {
+            TimerEntry * const next = entry->Next;
+
+            if (entry->Deadline <= event)
+            {
+                ++entry->Generation;
+                entry->Next = expired;
+                expired = entry;
+            }
+            else
+                InsertEntry(entry);
+            //  Cascades onto a lower level.
+
+            entry = next;
+        }
+    }
+
+    if (now > MyWheel.Time)
+        MyWheel.Time = now;
+    //  No event is skipped, so every pending entry stays in a valid slot.
+
+    return expired;
+}
+
+static __hot void ArmTimer(uint64_t const now)
+{
+    uint64_t const event = GetNextDeadline();
+
+    if (event == MyWheel.Armed)
+        return;
+
+    MyWheel.Armed = event;
+
+    if (ApicTimer::TscDeadline)
+        return ApicTimer::SetDeadline(event == NoDeadline ? 0 : event);
+    //  No conversion, no reading back the current count.
+
+    if (event == NoDeadline)
+        return ApicTimer::Stop();
+
+    uint64_t const maxMicroseconds = 0xFFFFFFFFULL / ApicTimer::TicksPerMicrosecond;
+    uint64_t microseconds = event > now ? (event - now) / ApicTimer::CountsPerMicrosecond : 0;
+
+    if unlikely(microseconds > maxMicroseconds)
+        microseconds = maxMicroseconds;
+    //  The interrupt will come early, and the timer will simply be re-armed.
+
+    uint64_t const ticks = microseconds * ApicTimer::TicksPerMicrosecond;
+
+    ApicTimer::SetCount(ticks > 0 ? (uint32_t)ticks : 1);
+}
 
 static __hot void TimerIrqHandler(InterruptContext const * context, void * cookie)
 {
     (void)context;
     (void)cookie;
 
-    auto timersCount = MyTimersCount;
+    uint64_t const now = GetNow();
+
+    TimerEntry * entry = AdvanceWheel(now);
+
+    MyWheel.Armed = NoDeadline;
+    ArmTimer(now);
 
-    if likely(timersCount > 0)
+    //  It is VITAL that the timer is armed again before the functions are
+    //  called, because a function could enable interrupts and get pre-empted
+    //  or something, and end up finishing the interrupt on another core.
+
+    while (entry != nullptr)
     {
-        TimerEntry const entry = MyTimers[0];
+        TimerEntry * const next = entry->Next;
+        TimedFunctionVoid const func = entry->Function;
+        void * const entryCookie = entry->Cookie;
 
-        MyTimersCount = --timersCount;
-        //  First timer is popped.
+        FreeEntry(entry);
+        //  Freed before the call so the function can enqueue again.
 
-        if (timersCount > 0)
-        {
-            memmove(&(MyTimers[0]), &(MyTimers[1]), timersCount * sizeof(TimerEntry));
-            //  Shifts the remaining items.
+        func(entryCookie);
 
-            uint32_t next = MyTimers[0].Time;
+        entry = next;
+    }
+}
 
-            if unlikely(next == 0)
-                next = 1;
-            
-            ApicTimer::SetCount(next);
+static __hot bool EnqueueLocal(TimeSpanLite delay, TimedFunctionVoid func, void * cookie
+    , TimerHandle * handle, TimeSpanLite slack)
+{
+    InterruptGuard<> intGuard;
 
-            //  It is VITAL that the timer is used again to guarantee that the
-            //  function runs on the same core again, because the function could
-            //  enable interrupts and get pre-empted or something, and end up
-            //  finishing the interrupt on another core.
-        }
+    TimerEntry * const entry = AllocateEntry();
+
+    if unlikely(entry == nullptr)
+        return false;
+
+    uint64_t const now = GetNow();
+    uint64_t deadline = now + (delay.Value > 0 ? delay.Value : 1) * ApicTimer::CountsPerMicrosecond;
+
+    if (slack.Value > 0)
+    {
+        uint64_t const mask = (1ULL << FastLog2(slack.Value * ApicTimer::CountsPerMicrosecond)) - 1;
+        uint64_t const rounded = (deadline + mask) & ~mask;
+
+        if likely(rounded > deadline)
+            deadline = rounded;
+        //  Rounding up adds at most the mask, which is below the slack.
+    }
+
+    entry->Deadline = deadline;
+    entry->Function = func;
+    entry->Cookie = cookie;
 
-        return entry.Function(entry.Cookie);
+    InsertEntry(entry);
+
+    if (handle != nullptr)
+    {
+        handle->Entry = entry;
+        handle->Generation = entry->Generation;
+        handle->Core = Cpu::GetData()->Index;
     }
+
+    if (deadline < MyWheel.Armed)
+        ArmTimer(now);
+
+    return true;
+}
+
+static __hot bool CancelLocal(TimerHandle const & handle)
+{
+    InterruptGuard<> intGuard;
+
+    TimerEntry * const entry = reinterpret_cast<TimerEntry *>(handle.Entry);
+
+    if (entry->Generation != handle.Generation)
+        return false;
+    //  Already expired or cancelled; the entry may even be pending again.
+
+    RemoveEntry(entry);
+    ++entry->Generation;
+    FreeEntry(entry);
+
+    ArmTimer(GetNow());
+    //  Only re-programs the timer if the earliest event changed.
+
+    return true;
+}
+
+#ifdef __BEELZEBUB_SETTINGS_SMP
+struct RemoteTimerRequest
+{
+    TimeSpanLite Delay, Slack;
+    TimedFunctionVoid Function;
+    void * Cookie;
+    TimerHandle * Handle;
+    TimerHandle const * CancelHandle;
+    bool Result;
+};
+
+static void RemoteEnqueue(void * cookie)
+{
+    RemoteTimerRequest * const req = reinterpret_cast<RemoteTimerRequest *>(cookie);
+
+    req->Result = EnqueueLocal(req->Delay, req->Function, req->Cookie, req->Handle, req->Slack);
 }
 
+static void RemoteCancel(void * cookie)
+{
+    RemoteTimerRequest * const req = reinterpret_cast<RemoteTimerRequest *>(cookie);
+
+    req->Result = CancelLocal(*req->CancelHandle);
+}
+
+static bool PostRemote(uint32_t core, MailFunction func, RemoteTimerRequest * req)
+{
+    ALLOCATE_MAIL(mail, 1, func, req);
+    mail.Links[0] = MailboxEntryLink(core);
+    mail.SetAwait(true);
+    //  The request lives on this stack, so the function must finish first.
+
+    mail.Post();
+
+    return req->Result;
+}
+#endif
+
 static SmpLock InitLock {};
 static bool Initialized = false;
 
@@ -116,9 +457,13 @@ static InterruptHandlerNode ApicTimerNode { &TimerIrqHandler, nullptr, Irqs::Hig
 
 void Timer::Initialize()
 {
-    MyTimersCount = 0;
+    MyWheel.Time = GetNow();
+    MyWheel.Armed = NoDeadline;
 
-    ApicTimer::OneShot(0, (uint8_t)Irqs::ApicTimer.Value, false);
+    if (ApicTimer::TscDeadline)
+        ApicTimer::Deadline((uint8_t)Irqs::ApicTimer.Value, false);
+    else
+        ApicTimer::OneShot(0, (uint8_t)Irqs::ApicTimer.Value, false);
 
     //  A lock is used here because this code must only be executed once, and
     //  other cores should wait for it to finish.
@@ -140,76 +485,42 @@ void Timer::Initialize()
 
 /*  Operation  */
 
-bool Timer::Enqueue(TimeSpanLite delay, TimedFunctionVoid func, void * cookie)
+bool Timer::Enqueue(TimeSpanLite delay, TimedFunctionVoid func, void * cookie
+    , TimerHandle * handle, TimeSpanLite slack)
 {
-    uint64_t ticks = delay.Value * ApicTimer::TicksPerMicrosecond;
-
-    if unlikely(ticks == 0)
-        ticks = 1;
-
-    InterruptGuard<> intGuard;
-
-    uint_fast16_t timersCount = MyTimersCount;
-
-    if unlikely(timersCount == Timer::Count)
-    {
-        MSG_("Too many timers!%n");
-        return false;
-    }
+    return EnqueueLocal(delay, func, cookie, handle, slack);
+}
 
-    if likely(timersCount > 0)
+bool Timer::EnqueueOn(uint32_t core, TimeSpanLite delay, TimedFunctionVoid func, void * cookie
+    , TimerHandle * handle, TimeSpanLite slack)
+{
+#ifdef __BEELZEBUB_SETTINGS_SMP
+    if (core != Cpu::GetData()->Index)
     {
-        //  If there are some timers already queued, the full algorithm needs to
-        //  be employed.
-
-        ticks += MyTimers[0].Time - ApicTimer::GetCount();
-        //  Add the already-elapsed time to the target time.
-
-        uint64_t lastTicks = 0;
-        unsigned int i = 0;
-
-        for (uint64_t acc = 0; i < timersCount && (acc += MyTimers[i].Time) <= ticks; ++i)
-            lastTicks = acc;
+        RemoteTimerRequest req { delay, slack, func, cookie, handle, nullptr, false };
 
-        if unlikely(ticks - lastTicks > 0xFFFFFFFFULL)
-            return false;
-        //  Difference is too large.
-
-        uint32_t diff = (uint32_t)(ticks - lastTicks);
-
-        if (i < timersCount)
-        {
-            ::memmove(&(MyTimers[i + 1]), &(MyTimers[i]), (timersCount - i) * sizeof(TimerEntry));
-            //  Shift forward the elements after the insertion point.
-
-            MyTimers[i + 1].Time -= diff;
-            //  Adjust timer after insertion point.
-        }
-
-        if (i == 0)
-            ApicTimer::SetCount(diff);
-
-        MyTimers[i].Time = diff;
-        MyTimers[i].Function = func;
-        MyTimers[i].Cookie = cookie;
-
-        ++MyTimersCount;
+        return PostRemote(core, &RemoteEnqueue, &req);
     }
-    else
-    {
-        //  No timers means a simple insertion at the first position.
+#else
+    assert(core == 0)(core);
+#endif
 
-        if unlikely(ticks > 0xFFFFFFFFULL)
-            return false;
+    return EnqueueLocal(delay, func, cookie, handle, slack);
+}
 
-        ApicTimer::SetCount((uint32_t)ticks);
+bool Timer::Cancel(TimerHandle const & handle)
+{
+    if unlikely(!handle.IsValid())
+        return false;
 
-        MyTimers[0].Time = (uint32_t)ticks;
-        MyTimers[0].Function = func;
-        MyTimers[0].Cookie = cookie;
+#ifdef __BEELZEBUB_SETTINGS_SMP
+    if (handle.Core != Cpu::GetData()->Index)
+    {
+        RemoteTimerRequest req { TimeSpanLite(), TimeSpanLite(), nullptr, nullptr, nullptr, &handle, false };
 
-        MyTimersCount = 1;
+        return PostRemote(handle.Core, &RemoteCancel, &req);
     }
+#endif
 
-    return true;
+    return CancelLocal(handle);
 }
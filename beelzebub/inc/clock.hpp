@@ -0,0 +1,109 @@
+/*
+    Copyright (c) 2017 Alexandru-Mihai Maftei. All rights reserved.
+
+
+    Developed by: Alexandru-Mihai Maftei
+    aka Vercas
+    http://vercas.com | https://github.com/vercas/Beelzebub
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to
+    deal with the Software without restriction, including without limitation the
+    rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+    sell copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+      * Redistributions of source code must retain the above copyright notice,
+        this list of conditions and the following disclaimers.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimers in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the names of Alexandru-Mihai Maftei, Vercas, nor the names of
+        its contributors may be used to endorse or promote products derived from
+        this Software without specific prior written permission.
+
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+    WITH THE SOFTWARE.
+
+    ---
+
+    You may also find the text of this license in "LICENSE.md", along with a more
+    thorough explanation regarding other files.
+*/
+
+#pragma once
+
+#include <beel/timing.hpp>
+#include <beel/handles.h>
+#include <execution/time_page.hpp>
+
+namespace Beelzebub
+{
+    /**
+     *  <summary>Known sources of monotonic time, in order of preference.</summary>
+     */
+    enum class ClockSource : uint8_t
+    {
+        None = 0,
+        Tsc  = 1,
+        Hpet = 2,
+        Pit  = 3,
+    };
+
+    /**
+     *  <summary>Represents the system's monotonic clock.</summary>
+     */
+    class Clock
+    {
+    public:
+        /*  Statics  */
+
+        static ClockSource Source;
+        static uint64_t Frequency;  //  Counts of the source per second.
+
+        static uint64_t Multiplier;
+        static uint8_t Shift;
+        static uint64_t Offset;
+        //  Microseconds are ((counts - Offset) * Multiplier) >> Shift.
+
+        static uint64_t BootEpoch;  //  Microseconds since the Unix epoch at instant 0.
+
+        static Execution::TimePage * SharedPage;
+        static paddr_t SharedPagePaddr;
+        //  Mapped read-only into processes, for reading the clock in userland.
+
+    protected:
+        /*  Constructor(s)  */
+
+        Clock() = default;
+
+    public:
+        Clock(Clock const &) = delete;
+        Clock & operator =(Clock const &) = delete;
+
+        /*  Initialization  */
+
+        static __startup Handle Initialize();
+
+        /*  Operation  */
+
+        /**
+         *  <summary>Gets the current instant, in microseconds since the clock was initialized.</summary>
+         */
+        static __hot TimeInstantLite Now();
+
+        /**
+         *  <summary>Gets the current number of microseconds since the Unix epoch.</summary>
+         */
+        static inline uint64_t GetWallTime()
+        {
+            return BootEpoch + Now().Value;
+        }
+    };
+}
@@ -60,6 +60,10 @@ namespace Beelzebub { namespace Execution
     class Process : public ProcessBase, public ProcessArchitecturalBase
     {
     public:
+        /*  Statics  */
+
+        static constexpr size_t const MaxTrackedCores = 256;
+
         /*  Constructors  */
 
         inline Process(uint16_t id = 0)
@@ -68,6 +72,7 @@ namespace Beelzebub { namespace Execution
             , State(ProcessState::Constructing)
             , Name(nullptr)
             , ActiveCoreCount(0)
+            , ActiveCores()
             , LocalTablesLock()
             , AlienPagingTablesLock()
             , Vas()
@@ -88,8 +93,26 @@ namespace Beelzebub { namespace Execution
         void SetName(char const * name);
 
         Synchronization::Atomic<size_t> ActiveCoreCount;
+        Synchronization::Atomic<uint64_t> ActiveCores[MaxTrackedCores / 64];
+        //  Cores which have this process' paging tables loaded.
         __hot Handle SwitchTo(Process * const other);
 
+        __hot void SetActiveCore(size_t const core, bool const active);
+
+        /**
+         *  <summary>
+         *  Determines whether the given core may hold translations of this
+         *  process. Untracked cores are always assumed to.
+         *  </summary>
+         */
+        __hot __forceinline bool IsActiveCore(size_t const core) const
+        {
+            if unlikely(core >= MaxTrackedCores)
+                return true;
+
+            return 0 != (this->ActiveCores[core / 64].Load() & (1ULL << (core % 64)));
+        }
+
         /*  Memory  */
 
         Synchronization::SmpLock LocalTablesLock;
@@ -62,8 +62,6 @@ namespace Beelzebub { namespace Execution
             , KernelStackPointer()
             , State()
             , ExtendedState(nullptr)
-            , Previous(nullptr)
-            , Next(nullptr)
             , EntryPoint()
         {
 
@@ -79,8 +77,6 @@ namespace Beelzebub { namespace Execution
             , KernelStackPointer()
             , State()
             , ExtendedState(nullptr)
-            , Previous(nullptr)
-            , Next(nullptr)
             , EntryPoint()
         {
 
@@ -89,7 +85,6 @@ namespace Beelzebub { namespace Execution
         /*  Operations  */
 
         __hot Handle SwitchTo(Thread * other, GeneralRegisters64 * dest);   //  Implemented in architecture-specific code.
-        Handle SwitchToNext(GeneralRegisters64 * dest) { return this->SwitchTo(this->Next, dest); }
 
         /*  Properties  */
 
@@ -107,15 +102,6 @@ namespace Beelzebub { namespace Execution
         ThreadState State;
         void * ExtendedState;
 
-        /*  Linkage  */
-
-        Thread * Previous;
-        Thread * Next;
-
-        Handle IntroduceNext(Thread * const other);
-
-        //  TODO: Eventually implement a proper scheduler and drop the linkage system.
-
         /*  Parameters  */
 
         ThreadEntryPointFunction EntryPoint;
@@ -49,6 +49,7 @@ namespace Beelzebub
     extern CommandLineOptionSpecification CMDO_Debugger;
     extern CommandLineOptionSpecification CMDO_UnitTests;
     extern CommandLineOptionSpecification CMDO_SmpEnable;
+    extern CommandLineOptionSpecification CMDO_FaultAround;
 
     extern CommandLineOptionSpecification * CommandLineOptionsHead;
 
@@ -55,10 +55,11 @@ namespace Beelzebub
     {
         /*  Constructor(s)  */
 
-        inline MailboxEntryLink() : Next( nullptr), Core(0) { }
+        inline MailboxEntryLink() : Next( nullptr), Owner(nullptr), Core(0) { }
 
         inline MailboxEntryLink(uint32_t core)
             : Next( nullptr)
+            , Owner(nullptr)
             , Core(core)
         {
 
@@ -66,7 +67,9 @@ namespace Beelzebub
 
         /*  Fields  */
 
-        MailboxEntryBase * Next;
+        MailboxEntryLink * Next;
+        MailboxEntryBase * Owner;
+        //  Each destination queues the entry through its own link.
 
         union
         {
@@ -106,6 +109,7 @@ namespace Beelzebub
 
         BITFIELD_FLAG_RW(0, Await, size_t, this->Flags, , const, static)
         BITFIELD_FLAG_RW(1, NonMaskable, size_t, this->Flags, , const, static)
+        BITFIELD_FLAG_RW(2, Pooled     , size_t, this->Flags, , const, static)
 
         /*  Fields  */
 
@@ -140,6 +144,37 @@ namespace Beelzebub
         MailboxEntryLink Destinations[N];
     };
 
+    /**
+     *  <summary>
+     *  Header of a mail entry which belongs to a per-core pool. The header is
+     *  followed by the entry, and that by enough links to reach every core in
+     *  the system.
+     *  </summary>
+     */
+    struct MailboxEntryPooled
+    {
+        /*  Fields  */
+
+        MailboxEntryPooled * PoolNext;
+        MailFunction Completion;
+        void * CompletionCookie;
+        uint32_t HomeCore;
+
+        /*  Operations  */
+
+        inline MailboxEntryBase * GetEntry()
+        {
+            return reinterpret_cast<MailboxEntryBase *>(this + 1);
+        }
+
+        static inline MailboxEntryPooled * FromEntry(MailboxEntryBase * entry)
+        {
+            return reinterpret_cast<MailboxEntryPooled *>(entry) - 1;
+        }
+    };
+
+    static_assert(sizeof(MailboxEntryPooled) % alignof(MailboxEntryBase) == 0, "Pooled mail entry header misaligns its entry.");
+
     /**
      *  <summary>Represents an abstract system mailbox.</summary>
      */
@@ -167,10 +202,29 @@ namespace Beelzebub
 
         /*  Operation  */
 
-        // static MailboxEntryBase * GetLocalEntry();
+        /**
+         *  <summary>
+         *  Obtains a mail entry from the current core's pool, or null if the
+         *  pool is exhausted. The entry must be posted with <see cref="PostAsync"/>.
+         *  </summary>
+         *  <remarks>
+         *  This must not be called from within a non-maskable mail function.
+         *  </remarks>
+         */
+        static __hot MailboxEntryBase * GetLocalEntry(unsigned int destCnt, MailFunction func, void * cookie = nullptr);
 
         static __solid void Post(MailboxEntryBase * entry, TimeWaster waster = nullptr, void * cookie = nullptr, bool poll = true);
 
+        /**
+         *  <summary>
+         *  Posts a pooled mail entry without waiting for its destinations. The
+         *  completion function is called, on whichever core finishes last, once
+         *  every destination is done with it; the entry returns to its pool
+         *  right afterwards.
+         *  </summary>
+         */
+        static __solid void PostAsync(MailboxEntryBase * entry, MailFunction completion = nullptr, void * cookie = nullptr);
+
         static inline void Post(MailboxEntryBase * entry, bool poll, TimeWaster waster = nullptr, void * cookie = nullptr)
         {
             return Post(entry, waster, cookie, poll);
@@ -180,7 +234,6 @@ namespace Beelzebub
 #define ALLOCATE_MAIL_4(name, dstcnt, func, cookie) \
     __extension__ void * MCATS(__, name, _buff)[(sizeof(Beelzebub::MailboxEntryBase) + (dstcnt) * sizeof(Beelzebub::MailboxEntryLink) + sizeof(void *) - 1) / sizeof(void *)]; \
     Beelzebub::MailboxEntryBase & name = *(new (reinterpret_cast<Beelzebub::MailboxEntryBase *>(&(MCATS(__, name, _buff)[0]))) Beelzebub::MailboxEntryBase((dstcnt), (func), (cookie)));
-    // Beelzebub::MailboxEntryBase & name = *(new (Beelzebub::Mailbox::GetLocalEntry()) Beelzebub::MailboxEntryBase((dstcnt), (func), (cookie)));;
 #define ALLOCATE_MAIL_3(name, dstcnt, func) ALLOCATE_MAIL_4(name, dstcnt, func, nullptr)
 #define ALLOCATE_MAIL_2(name, dstcnt) ALLOCATE_MAIL_3(name, dstcnt, nullptr)
 #define ALLOCATE_MAIL(name, ...) GET_MACRO3(__VA_ARGS__, ALLOCATE_MAIL_4, ALLOCATE_MAIL_3, ALLOCATE_MAIL_2)(name, __VA_ARGS__)
@@ -48,6 +48,51 @@
 
 namespace Beelzebub { namespace Memory
 {
+    /**
+     *  A NUMA node, identified by its ACPI proximity domain.
+     */
+    enum class NumaNode : uint32_t
+    {
+        Any = 0xFFFFFFFFU,
+    };
+
+    /**
+     *  Options for allocating frames.
+     */
+    enum class FrameAllocationOptions : uint8_t
+    {
+        //  Nothing special.
+        None    = 0x00,
+
+        //  The contents of the frame will be all zeros.
+        Zeroed  = 0x01,
+    };
+
+    __ENUMOPS(FrameAllocationOptions, uint8_t)
+
+    /**
+     *  A per-core stack of free frames of a single size. It is refilled and
+     *  drained in batches, so most allocations and frees do not touch the
+     *  locks of the allocation spaces.
+     */
+    template<size_t N>
+    struct FrameMagazine
+    {
+        /*  Constants  */
+
+        static constexpr size_t const Capacity = N;
+        static constexpr size_t const Batch = N / 2;
+
+        /*  Fields  */
+
+        size_t Count = 0;
+        paddr_t Frames[N];
+    };
+
+    typedef FrameMagazine<64> SmallFrameMagazine;
+    typedef FrameMagazine<4> LargeFrameMagazine;
+    //  Large frames are few; a core should not hoard many of them.
+
     /**
      *  The physical memory manager.
      */
@@ -67,7 +112,93 @@ namespace Beelzebub { namespace Memory
         static __hot __forceinline paddr_t AllocateFrame(uint32_t refCnt, AddressMagnitude magn, FrameSize size = FrameSize::_4KiB)
         { return AllocateFrame(size, magn, refCnt); }
 
+        /**
+         *  <summary>
+         *  Allocates a frame from the given node, falling back on other nodes
+         *  in order of distance. The overloads without a node prefer the node
+         *  of the current core.
+         *  </summary>
+         */
+        static __hot __solid paddr_t AllocateFrame(NumaNode node, FrameSize size = FrameSize::_4KiB, AddressMagnitude magn = AddressMagnitude::Any, uint32_t refCnt = 0);
+
+        static NumaNode GetLocalNode();
+
+        /**
+         *  <summary>Gets the node whose memory holds the given frame.</summary>
+         *  <return>The node, or <see cref="NumaNode::Any"/> for unmanaged frames.</return>
+         */
+        static NumaNode GetFrameNode(paddr_t addr);
+
+        /**
+         *  <summary>Gets the relative distance between two nodes, 10 being local.</summary>
+         */
+        static uint32_t GetNodeDistance(NumaNode from, NumaNode to);
+
+        /**
+         *  <summary>
+         *  Allocates a frame with the given options. Zeroed frames are taken
+         *  from a pool that idle cores keep filled, if possible.
+         *  </summary>
+         */
+        static __hot paddr_t AllocateFrame(FrameAllocationOptions opts, FrameSize size = FrameSize::_4KiB, AddressMagnitude magn = AddressMagnitude::Any, uint32_t refCnt = 0);
+
+        /**
+         *  <summary>
+         *  Allocates up to <paramref name="count"/> frames of the given size
+         *  into <paramref name="addrs"/>, taking each allocation space lock
+         *  once per run of frames.
+         *  </summary>
+         *  <return>The number of frames allocated; less than requested when memory runs out.</return>
+         */
+        static __hot __solid size_t AllocateFrames(size_t count, FrameSize size, paddr_t * addrs, AddressMagnitude magn = AddressMagnitude::Any, uint32_t refCnt = 0);
+
+        /**
+         *  <summary>
+         *  Allocates up to <paramref name="count"/> frames with the given
+         *  options. Zeroed frames are drained from the pool in one go, and the
+         *  shortfall is allocated in a batch and cleared here.
+         *  </summary>
+         *  <return>The number of frames allocated; less than requested when memory runs out.</return>
+         */
+        static __hot size_t AllocateFrames(FrameAllocationOptions opts, size_t count, FrameSize size, paddr_t * addrs, AddressMagnitude magn = AddressMagnitude::Any, uint32_t refCnt = 0);
+
+        /**
+         *  <summary>
+         *  Allocates physically contiguous memory. Blocks smaller than a large
+         *  frame are rounded up to a power of two and aligned to their size;
+         *  larger ones are rounded up to large frames. The block is made of
+         *  individual frames, each with the given reference count.
+         *  </summary>
+         */
+        static __solid paddr_t AllocateContiguous(psize_t size, psize_t alignment = psize_t(0), AddressMagnitude magn = AddressMagnitude::Any, uint32_t refCnt = 0);
+
+        /**
+         *  <summary>
+         *  Frees a contiguous block, given the size it was requested with.
+         *  </summary>
+         */
+        static __solid Handle FreeContiguous(paddr_t addr, psize_t size, bool ignoreRefCnt = true);
+
         static __hot __solid Handle FreeFrame(paddr_t addr, bool ignoreRefCnt = true);
+
+        /**
+         *  <summary>
+         *  Frees the given frames, which may be of mixed sizes, in batches.
+         *  Frames which cannot be freed are skipped.
+         *  </summary>
+         *  <return>The first failure encountered, or okay.</return>
+         */
+        static __hot __solid Handle FreeFrames(paddr_t const * addrs, size_t count, bool ignoreRefCnt = true);
+
+        /**
+         *  <summary>
+         *  Drops one reference from each of the given frames, and frees in
+         *  batches those which are left without any.
+         *  </summary>
+         *  <return>The first failure encountered, or okay.</return>
+         */
+        static __hot __solid Handle ReleaseFrames(paddr_t const * addrs, size_t count);
+
         static __cold __solid Handle ReserveRange(paddr_t start, psize_t size, bool includeBusy = false);
 
         static __hot __solid Handle AdjustReferenceCount(paddr_t addr, uint32_t & newCnt, int32_t diff);
@@ -80,5 +211,16 @@ namespace Beelzebub { namespace Memory
         }
 
         static __solid Handle GetFrameInfo(paddr_t addr, FrameSize & size, uint32_t & refCnt);
+
+        /*  Zeroed frames  */
+
+        /**
+         *  <summary>
+         *  Clears one frame and adds it to the pool of zeroed frames. Meant to
+         *  be called by idle cores.
+         *  </summary>
+         *  <return>True if a frame was added; false if the pool is full or memory ran out.</return>
+         */
+        static __cold bool ReplenishZeroedFrames();
     };
 }}
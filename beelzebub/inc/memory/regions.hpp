@@ -122,6 +122,7 @@ namespace Beelzebub { namespace Memory
             , Content()
             , Next(nullptr)
             , Prev(nullptr)
+            , LargestFree(0)
         {
 
         }
@@ -136,6 +137,7 @@ namespace Beelzebub { namespace Memory
             , Content(content)
             , Next(nullptr)
             , Prev(nullptr)
+            , LargestFree(0)
         {
 
         }
@@ -150,6 +152,7 @@ namespace Beelzebub { namespace Memory
             , Content(content)
             , Next(nullptr)
             , Prev(nullptr)
+            , LargestFree(0)
         {
 
         }
@@ -165,6 +168,7 @@ namespace Beelzebub { namespace Memory
             , Content(content)
             , Next(next)
             , Prev(prev)
+            , LargestFree(0)
         {
 
         }
@@ -202,6 +206,9 @@ namespace Beelzebub { namespace Memory
         MemoryContent Content;
 
         MemoryRegion * Next, * Prev;
+
+        vsize_t LargestFree;
+        //  Size of the largest free region in the subtree of this one's node.
     };
 
     struct AdjacentMemoryRegion
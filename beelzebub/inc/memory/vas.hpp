@@ -47,6 +47,31 @@
 #include <beel/sync/rw.ticket.lock.hpp>
 #include <beel/sync/atomic.hpp>
 
+namespace Beelzebub { namespace Utils
+{
+    /**
+     *  Summarizes the largest free region of every subtree, so anonymous
+     *  allocations can find room without visiting every region.
+     */
+    template<>
+    struct AvlTreeAugmentation<Memory::MemoryRegion>
+    {
+        static inline void Update(AvlTreeNode<Memory::MemoryRegion> * const node)
+        {
+            Memory::MemoryRegion & reg = node->Payload;
+
+            vsize_t largest { reg.Content == MemoryContent::Free ? reg.GetSize().Value : 0 };
+
+            if (node->Left != nullptr && node->Left->Payload.LargestFree > largest)
+                largest = node->Left->Payload.LargestFree;
+            if (node->Right != nullptr && node->Right->Payload.LargestFree > largest)
+                largest = node->Right->Payload.LargestFree;
+
+            reg.LargestFree = largest;
+        }
+    };
+}}
+
 namespace Beelzebub { namespace Memory
 {
     /**
@@ -63,6 +88,7 @@ namespace Beelzebub { namespace Memory
             , Tree()
             , First(nullptr)
             , LastSearched(nullptr)
+            , Collapsing(nullvaddr)
         {
             this->Tree.Cookie = this;
         }
@@ -119,5 +145,8 @@ namespace Beelzebub { namespace Memory
         Utils::AvlTree<MemoryRegion> Tree;
 
         MemoryRegion * First, * LastSearched;
+
+        vaddr_t Collapsing;
+        //  The large span whose small pages are being collapsed, if any.
     };
 }}
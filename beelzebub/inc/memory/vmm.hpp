@@ -106,6 +106,17 @@ namespace Beelzebub { namespace Memory
         static vaddr_t KernelStart;
         static vaddr_t KernelEnd;
 
+        static size_t const FaultAroundMaxPages = 16;
+
+        /**
+         *  <summary>
+         *  Number of pages around a faulting page of an on-demand region which
+         *  are populated along with it. Rounded down to a power of two, and
+         *  capped at FaultAroundMaxPages; 1 disables it.
+         *  </summary>
+         */
+        static size_t FaultAroundPages;
+
         /*  Utils  */
 
         static Handle AcquirePoolForVas(size_t objectSize, size_t headerSize
@@ -136,6 +147,8 @@ namespace Beelzebub { namespace Memory
 
         /*  Page Management  */
 
+        static bool SupportsFrameSize(FrameSize size);
+
         static __hot __solid Handle MapPage(Execution::Process * proc
             , vaddr_t const vaddr, paddr_t paddr
             , FrameSize size
@@ -213,6 +226,15 @@ namespace Beelzebub { namespace Memory
             return InvalidateChain(proc, PageNode(vaddr), broadcast);
         }
 
+        /**
+         *  <summary>
+         *  Flushes every translation of the given process, or every global one
+         *  too if the given address is shared by all processes.
+         *  </summary>
+         */
+        static __hot __solid Handle FlushTlb(Execution::Process * proc
+            , vaddr_t const vaddr, bool broadcast = true);
+
         static __hot __solid Handle Translate(Execution::Process * proc
             , vaddr_t const vaddr, paddr_t & paddr, bool const lock = true);
 
@@ -238,5 +260,71 @@ namespace Beelzebub { namespace Memory
 
         static __hot __solid Handle SetPageFlags(Execution::Process * proc
             , vaddr_t const vaddr, MemoryFlags const flags, bool const lock = true);
+
+        /**
+         *  <summary>
+         *  Sets the flags of every page in the given range, walking the tables
+         *  once and invalidating the changed pages together.
+         *  </summary>
+         *  <return>PageUnmapped if a hole is found; the pages before it are changed.</return>
+         */
+        static __hot __solid Handle SetRangeFlags(Execution::Process * proc
+            , vaddr_t vaddr, vsize_t size, MemoryFlags const flags, bool const lock = true);
+
+        /*  Large Pages  */
+
+        /**
+         *  <summary>
+         *  Counts the small pages mapped in the large span starting at the
+         *  given address, which must belong to an active address space.
+         *  </summary>
+         *  <return>
+         *  PageUnmapped if the span has no table of small pages, so a large page
+         *  can be mapped there; PageMapped if a large page already covers it.
+         *  </return>
+         */
+        static __hot __solid Handle CountSmallPages(Execution::Process * proc
+            , vaddr_t const vaddr, size_t & count);
+
+        /**
+         *  <summary>
+         *  Replaces a full table of small pages with identical flags by a
+         *  large page holding a copy of their contents. Writes to the span
+         *  fault while it is copied, so the span must be advertised in the
+         *  Collapsing field of its VAS.
+         *  </summary>
+         */
+        static __solid Handle CollapseLargePage(Execution::Process * proc
+            , vaddr_t const vaddr);
+
+        /*  Copy-on-Write  */
+
+        /**
+         *  <summary>
+         *  Gives a freshly initialized process the regions of another and
+         *  shares all of its userland frames, read-only in both. Whichever
+         *  process writes to a page first receives its own copy.
+         *  </summary>
+         */
+        static __cold Handle CloneAddressSpace(Execution::Process * src
+            , Execution::Process * dst);
+
+        /**
+         *  <summary>
+         *  Maps every userland page of the active process in the given alien
+         *  process, write-protecting it in both.
+         *  </summary>
+         */
+        static __cold Handle ClonePagingTables(Execution::Process * src
+            , Execution::Process * dst);
+
+        /**
+         *  <summary>
+         *  Makes a write-protected page of a writable region writable, copying
+         *  it unless the process holds the only reference to its frame.
+         *  </summary>
+         */
+        static __hot Handle BreakCopyOnWrite(Execution::Process * proc
+            , vaddr_t const vaddr);
     };
 }}
@@ -72,6 +72,20 @@ namespace Beelzebub
 
         static __cold void Engage();
 
+        /*  Operation  */
+
+        static Handle Enqueue(Execution::Thread * thread);
+
+        static __hot void Preempt(GeneralRegisters64 * state);
+
+        /**
+         *  <summary>
+         *  Makes the active thread give up its core for good, which goes idle
+         *  if it has nothing else to run.
+         *  </summary>
+         */
+        static __cold __noreturn void Retire();
+
         /*  Properties  */
 
         static size_t GetMaximumProcesses();
@@ -49,6 +49,26 @@ namespace Beelzebub
     template<typename TCookie>
     using TimedFunction = void (*)(TCookie *);
 
+    /**
+     *  <summary>Identifies a pending timer so it can be cancelled.</summary>
+     */
+    struct TimerHandle
+    {
+        /*  Constructor(s)  */
+
+        inline constexpr TimerHandle() : Entry( nullptr), Generation(0), Core(0) { }
+
+        /*  Properties  */
+
+        inline bool IsValid() const { return this->Entry != nullptr; }
+
+        /*  Fields  */
+
+        void * Entry;
+        uint32_t Generation;
+        uint32_t Core;
+    };
+
     /**
      *  <summary>Represents an abstract system timer.</summary>
      */
@@ -60,8 +80,6 @@ namespace Beelzebub
         static uint64_t Frequency;
         static size_t TicksPerMicrosecond;
 
-        static constexpr uint_fast16_t const Count = 32;
-
     protected:
         /*  Constructor(s)  */
 
@@ -77,12 +95,41 @@ namespace Beelzebub
 
         /*  Operation  */
 
-        static bool Enqueue(TimeSpanLite delay, TimedFunctionVoid func, void * cookie = nullptr);
+        /**
+         *  <summary>Calls the given function on this core after the given delay.</summary>
+         *  <param name="handle">Optional; receives a handle for cancelling the timer.</param>
+         *  <param name="slack">
+         *  How much later than the delay the function may be called, so that
+         *  it can share an interrupt with nearby timers.
+         *  </param>
+         */
+        static bool Enqueue(TimeSpanLite delay, TimedFunctionVoid func, void * cookie = nullptr
+            , TimerHandle * handle = nullptr, TimeSpanLite slack = TimeSpanLite());
 
         template<typename TCookie>
-        static bool Enqueue(TimeSpanLite delay, TimedFunction<TCookie> func, TCookie * cookie)
+        static bool Enqueue(TimeSpanLite delay, TimedFunction<TCookie> func, TCookie * cookie
+            , TimerHandle * handle = nullptr, TimeSpanLite slack = TimeSpanLite())
         {
-            return Enqueue(delay, static_cast<TimedFunctionVoid>(func), cookie);
+            return Enqueue(delay, reinterpret_cast<TimedFunctionVoid>(func), cookie, handle, slack);
         }
+
+        /**
+         *  <summary>Calls the given function on the given core after the given delay.</summary>
+         */
+        static bool EnqueueOn(uint32_t core, TimeSpanLite delay, TimedFunctionVoid func, void * cookie = nullptr
+            , TimerHandle * handle = nullptr, TimeSpanLite slack = TimeSpanLite());
+
+        template<typename TCookie>
+        static bool EnqueueOn(uint32_t core, TimeSpanLite delay, TimedFunction<TCookie> func, TCookie * cookie
+            , TimerHandle * handle = nullptr, TimeSpanLite slack = TimeSpanLite())
+        {
+            return EnqueueOn(core, delay, reinterpret_cast<TimedFunctionVoid>(func), cookie, handle, slack);
+        }
+
+        /**
+         *  <summary>Cancels a pending timer, on whichever core it was enqueued.</summary>
+         *  <return>True if the timer was pending; false if it already fired or was cancelled.</return>
+         */
+        static bool Cancel(TimerHandle const & handle);
     };
 }
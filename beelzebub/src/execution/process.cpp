@@ -39,10 +39,12 @@
 
 #include <execution/thread.hpp>
 #include <memory/vmm.hpp>
+#include <system/cpu.hpp>
 
 using namespace Beelzebub;
 using namespace Beelzebub::Execution;
 using namespace Beelzebub::Memory;
+using namespace Beelzebub::System;
 
 /********************
     Process class
@@ -76,10 +78,21 @@ Handle Process::SwitchTo(Process * const other)
 
     if likely(this != other)
     {
+        size_t const core = Cpu::GetData()->Index;
+
+        other->SetActiveCore(core, true);
+        //  Before the switch, so no shootdown can miss this core.
+
         res = Vmm::Switch(this, other);
 
         if unlikely(!res.IsOkayResult())
+        {
+            other->SetActiveCore(core, false);
+
             return res;
+        }
+
+        this->SetActiveCore(core, false);
 
         ++other->ActiveCoreCount;
         --this->ActiveCoreCount;
@@ -89,3 +102,15 @@ Handle Process::SwitchTo(Process * const other)
 
     return HandleResult::Okay;
 }
+
+void Process::SetActiveCore(size_t const core, bool const active)
+{
+    if unlikely(core >= MaxTrackedCores)
+        return;
+    //  Such cores always receive shootdowns.
+
+    if (active)
+        this->ActiveCores[core / 64].TestSet(core % 64);
+    else
+        this->ActiveCores[core / 64].TestClear(core % 64);
+}
@@ -48,6 +48,7 @@ CommandLineOptionSpecification Beelzebub::CMDO_Tests;
 CommandLineOptionSpecification Beelzebub::CMDO_Debugger;
 CommandLineOptionSpecification Beelzebub::CMDO_UnitTests;
 CommandLineOptionSpecification Beelzebub::CMDO_SmpEnable;
+CommandLineOptionSpecification Beelzebub::CMDO_FaultAround;
 
 CommandLineOptionSpecification * Beelzebub::CommandLineOptionsHead;
 
@@ -58,8 +59,9 @@ Handle Beelzebub::InstanceGlobalOptions()
     CMDO_LINKED_EX(Tests, nullptr, "tests", String, Debugger);
     CMDO_LINKED_EX(UnitTests, nullptr, "unit-tests", BooleanByPresence, Tests);
     CMDO_LINKED_EX(SmpEnable, nullptr, "smp", BooleanExplicit, UnitTests);
+    CMDO_LINKED_EX(FaultAround, nullptr, "fault-around", UnsignedInteger, SmpEnable);
 
-    CommandLineOptionsHead = &CMDO_SmpEnable;
+    CommandLineOptionsHead = &CMDO_FaultAround;
 
     return HandleResult::Okay;
 }
@@ -64,6 +64,28 @@ struct AnonymousAllocationResults
     bool Fits;
 };
 
+/**
+ *  <summary>
+ *  Finds the lowest free region of at least the given size.
+ *  </summary>
+ */
+static __hot MemoryRegion * FindFreeRegion(AvlTree<MemoryRegion>::Node * node, vsize_t const size)
+{
+    while (node != nullptr && node->Payload.LargestFree >= size)
+    {
+        //  This subtree has room, so it's somewhere in here.
+
+        if (node->Left != nullptr && node->Left->Payload.LargestFree >= size)
+            node = node->Left;
+        else if (node->Payload.Content == MemoryContent::Free && node->Payload.GetSize() >= size)
+            return &(node->Payload);
+        else
+            node = node->Right;
+    }
+
+    return nullptr;
+}
+
 struct OperationParameters
 {
     /*  Constructor(s)  */
@@ -125,6 +147,7 @@ struct OperationParameters
         MemoryRegion * reg;
         vaddr_t continuation;
         DescriptorCheckResults dcr;
+        bool touched = false;
 
         InterruptState cookie;
 
@@ -148,9 +171,10 @@ struct OperationParameters
         {
             //  Null vaddr on allocation means any address is accepted.
 
-            reg = vas->First;
+            reg = FindFreeRegion(vas->Tree.Root, this->StartSize);
+            //  No region below this one is free and large enough.
 
-            do
+            while (reg != nullptr)
             {
                 if (reg->Content == MemoryContent::Free && this->CanAllocateAnonymously(reg))
                 {
@@ -164,7 +188,7 @@ struct OperationParameters
                 //  If not, move on.
 
                 reg = reg->Next;
-            } while (reg != nullptr);
+            }
 
             //  Reaching this point means there is no space to spare!
 
@@ -226,6 +250,8 @@ struct OperationParameters
 
         if (dcr.Accepted)
         {
+            touched = true;
+
             if (0 != (reg->Type & MemoryAllocationOptions::Permanent))
             {
                 //  Permanent allocations cannot be manipulated.
@@ -496,6 +522,18 @@ struct OperationParameters
         }
 
     end:
+        if (touched)
+        {
+            vaddr_t const stepEnd = continuation != nullvaddr ? continuation : endAddr;
+
+            vas->Tree.Refresh<vaddr_t>(vaddr - vsize_t(1));
+            vas->Tree.Refresh<vaddr_t>(vaddr);
+            vas->Tree.Refresh<vaddr_t>(stepEnd - vsize_t(1));
+            vas->Tree.Refresh<vaddr_t>(stepEnd);
+            //  Regions are resized and repurposed in place, but only the ones
+            //  around the edges of the operated range.
+        }
+
         if (vas->ImplementsPostOp())
             res = vas->PostOp(res, lock, this->Allocation);
 
@@ -614,14 +652,31 @@ Handle Vas::Allocate(vaddr_t & vaddr, vsize_t size
 
         virtual bool CanAllocateAnonymously(MemoryRegion * reg) override
         {
-            //  TODO: Alignment rules.
+            if (reg->GetSize() < this->StartSize)
+                return false;
 
-            bool res = reg->GetSize() >= this->StartSize;
+            this->Address = reg->Range.End - this->StartSize;
 
-            if (res)
-                this->Address = reg->Range.End - this->StartSize;
+            vsize_t const lowOffset { 0 != (this->Type & MemoryAllocationOptions::GuardLow) ? PageSize.Value : 0 };
+            vsize_t const usable = this->StartSize - lowOffset;
+            vsize_t align { 0 };
 
-            return res;
+            if (usable >= HugePageSize)
+                align = HugePageSize;
+            else if (usable >= LargePageSize)
+                align = LargePageSize;
+            //  Large allocations are aligned so they can be backed by large pages.
+
+            if (align != vsize_t(0))
+            {
+                vaddr_t const aligned = RoundDown(this->Address + lowOffset, align) - lowOffset;
+
+                if (aligned >= reg->Range.Start && aligned <= this->Address)
+                    this->Address = aligned;
+                //  If the aligned placement doesn't fit, the unaligned one is kept.
+            }
+
+            return true;
         }
 
         /*  Fields  */
@@ -65,6 +65,132 @@ static __forceinline bool Is4KiBAligned(TInt val) { return (val.Value & (     Pa
 template<typename TInt>
 static __forceinline bool Is2MiBAligned(TInt val) { return (val.Value & (LargePageSize.Value - 1)) == 0; }
 
+/**
+ *  <summary>
+ *  Gets the range of a region which may be populated on demand, which excludes
+ *  its guard pages.
+ *  </summary>
+ */
+static __forceinline void GetDemandableRange(MemoryRegion const * reg, vaddr_t & start, vaddr_t & end)
+{
+    start = reg->Range.Start;
+    end = reg->Range.End;
+
+    if (0 != (reg->Type & MemoryAllocationOptions::GuardLow )) start += PageSize;
+    if (0 != (reg->Type & MemoryAllocationOptions::GuardHigh)) end   -= PageSize;
+}
+
+static __forceinline bool CanMapLargePage(MemoryRegion const * reg, vaddr_t const span)
+{
+    vaddr_t start, end;
+    GetDemandableRange(reg, start, end);
+
+    return span >= start && span + LargePageSize <= end;
+}
+
+/**
+ *  <summary>
+ *  Collapses the small pages of a large span, unless another core is already
+ *  collapsing a span of the same VAS. The VAS must be locked as reader.
+ *  </summary>
+ */
+static void CollapseSpan(Process * proc, Vas * vas, vaddr_t const span)
+{
+    uintptr_t expected = 0;
+
+    if (!__atomic_compare_exchange_n(&(vas->Collapsing.Value), &expected, span.Value
+        , false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+        return;
+
+    Vmm::CollapseLargePage(proc, span);
+    //  Failure only means the span stays made of small pages.
+
+    __atomic_store_n(&(vas->Collapsing.Value), (uintptr_t)0, __ATOMIC_RELEASE);
+}
+
+/**
+ *  <summary>
+ *  Populates the unmapped pages of the fault-around window which contains the
+ *  given (already mapped) page, within the bounds of the region. Pages after
+ *  the faulting one are preferred if memory is short.
+ *  </summary>
+ *  <return>
+ *  A bitmap of the pages mapped, counted from <paramref name="start"/>, which
+ *  receives the start of the window.
+ *  </return>
+ */
+static uint64_t FaultAround(Process * proc, MemoryRegion const * reg
+    , vaddr_t const vaddr, bool const zeroed, vaddr_t & start)
+{
+    size_t window = Vmm::FaultAroundPages;
+
+    if (window > Vmm::FaultAroundMaxPages)
+        window = Vmm::FaultAroundMaxPages;
+
+    if (window < 2)
+        return 0;
+
+    vsize_t const windowSize { PageSize.Value << FastLog2<size_t>(window) };
+
+    start = RoundDown(vaddr, windowSize);
+
+    vaddr_t first = start, end = start + windowSize;
+    vaddr_t regStart, regEnd;
+
+    GetDemandableRange(reg, regStart, regEnd);
+
+    if (first < regStart) first = regStart;
+    if (end   > regEnd  ) end   = regEnd;
+
+    uint64_t wanted = 0;
+    size_t count = 0;
+
+    for (vaddr_t cur = first; cur < end; cur += PageSize)
+    {
+        paddr_t paddr;
+
+        if (!Vmm::Translate(proc, cur, paddr).IsOkayResult())
+        {
+            wanted |= 1ULL << ((cur - start).Value / PageSize.Value);
+            ++count;
+        }
+    }
+
+    if (count == 0)
+        return 0;
+
+    paddr_t paddrs[Vmm::FaultAroundMaxPages];
+
+    count = Pmm::AllocateFrames(zeroed ? FrameAllocationOptions::Zeroed : FrameAllocationOptions::None
+        , count, FrameSize::_4KiB, paddrs);
+    //  Running short on memory merely shrinks the window.
+
+    size_t const pivot = (vaddr - start).Value / PageSize.Value;
+    uint64_t const halves[2] = { wanted & ~((2ULL << pivot) - 1), wanted & ((1ULL << pivot) - 1) };
+    //  Forward first, because that is where sequential access goes next.
+
+    uint64_t mapped = 0;
+    size_t used = 0, failed = 0;
+
+    for (uint64_t pending : halves)
+        for (/* nothing */; pending != 0 && used < count; pending &= pending - 1)
+        {
+            size_t const bit = (size_t)__builtin_ctzll(pending);
+            paddr_t const paddr = paddrs[used++];
+
+            if likely(Vmm::MapPage(proc, start + vsize_t(bit * PageSize.Value), paddr, reg->Flags) == HandleResult::Okay)
+                mapped |= 1ULL << bit;
+            else
+                paddrs[failed++] = paddr;
+            //  Another core may have mapped it meanwhile.
+        }
+
+    if unlikely(failed > 0)
+        Pmm::FreeFrames(paddrs, failed);
+
+    return mapped;
+}
+
 /****************
     Vmm class
 ****************/
@@ -75,6 +201,8 @@ SmpLock Vmm::KernelHeapLock;
 
 KernelVas Vmm::KVas;
 
+size_t Vmm::FaultAroundPages = 16;
+
 /*  Page Management  */
 
 Handle Vmm::HandlePageFault(Execution::Process * proc
@@ -82,10 +210,6 @@ Handle Vmm::HandlePageFault(Execution::Process * proc
 {
     //  Assumes interrupts are disabled upon call.
 
-    if unlikely(0 != (flags & PageFaultFlags::Present))
-        return HandleResult::Failed;
-    //  Page is present. This means this is an access (write/execute) failure.
-
     if unlikely(!((vaddr >= Vmm::UserlandStart && vaddr <= Vmm::UserlandEnd)
                || (vaddr >= Vmm::KernelStart   && vaddr <= Vmm::KernelEnd  )))
         return HandleResult::Failed;
@@ -96,10 +220,52 @@ Handle Vmm::HandlePageFault(Execution::Process * proc
     Handle res = HandleResult::Okay;
     Memory::Vas * const vas = (vaddr < Vmm::UserlandEnd) ? &(proc->Vas) : &KVas;
 
+    vaddr_t const span = RoundDown(vaddr, LargePageSize);
+    MemoryRegion * reg;
+
+    if unlikely(0 != (flags & PageFaultFlags::Present))
+    {
+        //  Page is present. This means this is an access (write/execute)
+        //  failure, and only writes to write-protected pages are legitimate.
+
+        if (0 == (flags & PageFaultFlags::Write))
+            return HandleResult::Failed;
+
+        if (__atomic_load_n(&(vas->Collapsing.Value), __ATOMIC_ACQUIRE) == span.Value)
+            return HandleResult::Okay;
+        //  The page is read-only only while its span is being collapsed, so
+        //  the access is simply retried.
+
+        if (vaddr >= KernelStart)
+            return HandleResult::Failed;
+
+        vas->Lock.AcquireAsReader();
+
+        reg = vas->FindRegion(vaddr);
+
+        if likely(reg != nullptr
+            && reg->Content != MemoryContent::Free
+            && 0 != (reg->Flags & MemoryFlags::Writable)
+            && (0 == (flags & PageFaultFlags::Userland) || 0 != (reg->Flags & MemoryFlags::Userland)))
+            res = Vmm::BreakCopyOnWrite(proc, vaddr);
+        else
+            res = HandleResult::Failed;
+        //  A writable region with a read-only page means the page is shared
+        //  copy-on-write.
+
+        vas->Lock.ReleaseAsReader();
+
+        return res;
+    }
+
     paddr_t paddr;
+    bool zeroed, large = false, collapse = false;
+    size_t smallCount = 0;
+
+    vaddr_t aroundStart = nullvaddr;
+    uint64_t around = 0;
 
     vaddr_t const vaddr_algn = RoundDown(vaddr, PageSize);
-    MemoryRegion * reg;
 
     if unlikely(vaddr >= Vmm::KernelStart)
     {
@@ -148,7 +314,44 @@ Handle Vmm::HandlePageFault(Execution::Process * proc
     //  following allocation fails, because it doesn't affect the correctness of
     //  the VAS.
 
-    paddr = Pmm::AllocateFrame();
+    zeroed = vaddr < KernelStart && 0 != (reg->Flags & MemoryFlags::Writable);
+    //  Writable userland pages must come out clean.
+
+    if (likely(Cores::IsReady()) && CanMapLargePage(reg, span))
+    {
+        //  Large pages are only split for partial unmapping once cores are up.
+
+        res = Vmm::CountSmallPages(proc, span, smallCount);
+
+        if (res == HandleResult::PageUnmapped)
+        {
+            //  Nothing is mapped in the surrounding span, so it can be covered
+            //  by a large page.
+
+            paddr = zeroed
+                ? Pmm::AllocateFrame(FrameAllocationOptions::Zeroed, FrameSize::_2MiB)
+                : Pmm::AllocateFrame(FrameSize::_2MiB);
+
+            if likely(paddr != nullpaddr)
+            {
+                res = Vmm::MapPage(proc, span, paddr, FrameSize::_2MiB, reg->Flags);
+
+                if likely(res == HandleResult::Okay)
+                {
+                    large = true;
+
+                    goto mapped;
+                }
+
+                Pmm::FreeFrame(paddr);
+            }
+        }
+        else
+            collapse = res == HandleResult::Okay;
+        //  Otherwise, a small page it is.
+    }
+
+    paddr = zeroed ? Pmm::AllocateFrame(FrameAllocationOptions::Zeroed) : Pmm::AllocateFrame();
 
     if unlikely(paddr == nullpaddr)
         RETURN(OutOfMemory);
@@ -167,7 +370,12 @@ Handle Vmm::HandlePageFault(Execution::Process * proc
         Pmm::FreeFrame(paddr);
         //  Get rid of the physical page if mapping failed. :frown:
     }
+    else if (vaddr >= KernelStart || Vmm::IsActive(proc))
+        around = FaultAround(proc, reg, vaddr_algn, zeroed, aroundStart);
+    //  Neighbouring userland pages are filled through their mapping below, so
+    //  the process needs to be active.
 
+mapped:
     vas->Lock.ReleaseAsReader();
 
     // MSG_("Allocated on demand page %XP at %Xp.%n", paddr, vaddr_algn);
@@ -179,15 +387,21 @@ Handle Vmm::HandlePageFault(Execution::Process * proc
             //  This was a request in userland, therefore the page contents need to
             //  be TERMINATED.
 
-            if (0 != (reg->Flags & MemoryFlags::Writable))
-                memset(vaddr_algn, 0, PageSize);
-                //  This is allowed.
-            else
+            if (!zeroed)
                 withWriteProtect (false)
-                    memset(vaddr_algn, 0xCA, PageSize);
+                {
+                    if (large)
+                        memset(span, 0xCA, LargePageSize);
+                    else
+                        memset(vaddr_algn, 0xCA, PageSize);
+
+                    for (uint64_t m = around; m != 0; m &= m - 1)
+                        memset(aroundStart + vsize_t(__builtin_ctzll(m) * PageSize.Value), 0xCA, PageSize);
+                }
                 //  It's all CACA! It shouldn't be read, it should be written to using
                 //  a syscall.
         }
+
         // else
         // {
         //     ASSERTX(0 != (reg->Flags & MemoryFlags::Writable)
@@ -195,6 +409,18 @@ Handle Vmm::HandlePageFault(Execution::Process * proc
 
         //     memset(reinterpret_cast<void *>(vaddr_algn), 0, PageSize);
         // }
+
+        if (collapse && smallCount + 1 + (size_t)__builtin_popcountll(around) == LargePageSize.Value / PageSize.Value)
+        {
+            //  This fault filled the span, so its small pages are collapsed into
+            //  a large one now that their contents are final.
+
+            vas->Lock.AcquireAsReader();
+
+            CollapseSpan(proc, vas, span);
+
+            vas->Lock.ReleaseAsReader();
+        }
     }
 
     return HandleResult::Okay;
@@ -207,6 +433,47 @@ end:
     return res;
 }
 
+/*  Copy-on-Write  */
+
+Handle Vmm::CloneAddressSpace(Execution::Process * src, Execution::Process * dst)
+{
+    if (src == nullptr) src = likely(Cores::IsReady()) ? Cpu::GetProcess() : &BootstrapProcess;
+
+    if unlikely(src == dst)
+        return HandleResult::ArgumentOutOfRange;
+
+    Handle res = HandleResult::Okay;
+
+    src->Vas.Lock.AcquireAsReader();
+    dst->Vas.Lock.AcquireAsWriter();
+    //  Faults in the source may go on, but its regions may not change.
+
+    for (MemoryRegion const * reg = src->Vas.First; reg != nullptr; reg = reg->Next)
+    {
+        if (reg->Content == MemoryContent::Free)
+            continue;
+
+        vsize_t const lowOffset  { 0 != (reg->Type & MemoryAllocationOptions::GuardLow ) ? PageSize.Value : 0 };
+        vsize_t const highOffset { 0 != (reg->Type & MemoryAllocationOptions::GuardHigh) ? PageSize.Value : 0 };
+
+        vaddr_t vaddr = reg->Range.Start + lowOffset;
+
+        res = dst->Vas.Allocate(vaddr, reg->GetSize() - lowOffset - highOffset
+            , reg->Flags, reg->Content, reg->Type, false);
+
+        if unlikely(res != HandleResult::Okay)
+            goto end;
+    }
+
+    res = Vmm::ClonePagingTables(src, dst);
+
+end:
+    dst->Vas.Lock.ReleaseAsWriter();
+    src->Vas.Lock.ReleaseAsReader();
+
+    return res;
+}
+
 /*  Flags  */
 
 Handle Vmm::CheckMemoryRegion(Execution::Process * proc
@@ -344,19 +611,59 @@ Handle Vmm::AllocatePages(Process * proc, vsize_t const size
         LockGuard<SmpLock > heapLg {*heapLock};
         //  Note: this ain't flexible because heapLock ain't gonna be null.
 
+        static constexpr size_t const CommitBatch = 16;
+
+        paddr_t frames[CommitBatch];
+        size_t frameCount = 0, frameIndex = 0;
+        //  Frames are obtained in batches, to keep the PMM's locks cold.
+
+        bool const huge = Vmm::SupportsFrameSize(FrameSize::_1GiB);
+
         vsize_t offset { 0 };
         for (; offset < size; offset += PageSize)
         {
-            paddr_t const paddr = Pmm::AllocateFrame();
-
-            if unlikely(paddr == nullpaddr)
-                goto backtrack;
-
-            res = Vmm::MapPage(proc, ret + offset, paddr
+            if (huge && frameIndex == frameCount && size - offset >= HugePageSize
+                && ((ret + offset).Value & (HugePageSize.Value - 1)) == 0)
+            {
+                //  A whole 1-GiB page fits here, so one is attempted. On failure,
+                //  this falls back to 4-KiB frames.
+
+                paddr_t const hugeFrame = Pmm::AllocateFrame(FrameSize::_1GiB);
+
+                if (hugeFrame != nullpaddr)
+                {
+                    res = Vmm::MapPage(proc, ret + offset, hugeFrame
+                        , FrameSize::_1GiB, flags, MemoryMapOptions::NoLocking);
+
+                    if likely(res == HandleResult::Okay)
+                    {
+                        offset += vsize_t(HugePageSize.Value - PageSize.Value);
+                        //  The loop adds the last page.
+
+                        continue;
+                    }
+
+                    Pmm::FreeFrame(hugeFrame);
+                }
+            }
+
+            if (frameIndex == frameCount)
+            {
+                frameCount = Pmm::AllocateFrames(Minimum(CommitBatch, (size - offset).Value / PageSize.Value)
+                    , FrameSize::_4KiB, frames);
+                frameIndex = 0;
+
+                if unlikely(frameCount == 0)
+                    goto backtrack;
+            }
+
+            res = Vmm::MapPage(proc, ret + offset, frames[frameIndex]
                 , flags, MemoryMapOptions::NoLocking);
 
             if unlikely(res != HandleResult::Okay)
                 goto backtrack;
+
+            ++frameIndex;
         }
 
         if likely(0 != (type & MemoryAllocationOptions::VirtualUser))
@@ -367,7 +674,10 @@ Handle Vmm::AllocatePages(Process * proc, vsize_t const size
 
     backtrack:
         //  So, the allocation failed. Now all the pages that were allocated
-        //  need to be unmapped.
+        //  need to be unmapped, and the unused frames freed.
+
+        if (frameIndex < frameCount)
+            Pmm::FreeFrames(frames + frameIndex, frameCount - frameIndex);
 
         res = Vmm::UnmapRange(proc, ret, offset, MemoryMapOptions::NoLocking);
 
@@ -38,22 +38,44 @@
 */
 
 #include <sys/time.h>
-#include "system/timers/pit.hpp"
+#include "clock.hpp"
 
 using namespace Beelzebub;
-using namespace Beelzebub::System;
-using namespace Beelzebub::System::Timers;
 
 int gettimeofday(struct timeval * tv, struct timezone * tz)
 {
     (void)tz;
 
-    // if likely(tv != nullptr)
-    // {
-    //     size_t const counter = Pit::Counter.Load();
+    if likely(tv != nullptr)
+    {
+        uint64_t const now = Clock::GetWallTime();
 
-    //     *tv = {(time_t)(counter / 1000), (suseconds_t)((counter % 1000) * 1000)};
-    // }
+        *tv = {(time_t)(now / 1000000), (suseconds_t)(now % 1000000)};
+    }
+
+    return 0;
+}
+
+int clock_gettime(clockid_t clk, struct timespec * tp)
+{
+    uint64_t now;
+
+    switch (clk)
+    {
+    case CLOCK_REALTIME:
+        now = Clock::GetWallTime();
+        break;
+
+    case CLOCK_MONOTONIC:
+        now = Clock::Now().Value;
+        break;
+
+    default:
+        return -1;
+    }
+
+    if likely(tp != nullptr)
+        *tp = {(time_t)(now / 1000000), (long)(now % 1000000) * 1000};
 
     return 0;
 }
@@ -57,6 +57,9 @@ Barrier MailboxTestBarrier;
 
 static constexpr size_t const PingPongCount = 200000;
 static constexpr size_t const SpamCount = 200000;
+static constexpr size_t const AsyncCount = 100000;
+
+static Synchronization::Atomic<size_t> AsyncCompleted {0};
 
 struct PingPongState
 {
@@ -147,6 +150,11 @@ static __startup void TestEmptyFunc(void * cookie)
     return TestEmptyFunc2(cookie);
 }
 
+static __startup void AsyncCompletion(void * cookie)
+{
+    ++*reinterpret_cast<Synchronization::Atomic<size_t> *>(cookie);
+}
+
 void TestMailbox(bool bsp)
 {
     if (bsp)
@@ -195,6 +203,38 @@ void TestMailbox(bool bsp)
             << "Spam mail latency: AVG "
             << ((perfEnd - perfStart) / (SpamCount * Cores::GetCount())) << EndLine;
 
+    }
+
+    SYNC;
+
+    uint64_t const asyncStart = CpuInstructions::Rdtsc();
+
+    for (size_t i = 0; i < AsyncCount; ++i)
+    {
+        MailboxEntryBase * mail;
+
+        while ((mail = Mailbox::GetLocalEntry(1, &TestEmptyFunc)) == nullptr)
+            CpuInstructions::DoNothing();
+        //  The pool refills as other cores finish with the entries.
+
+        mail->Links[0] = MailboxEntryLink(Mailbox::Broadcast);
+
+        Mailbox::PostAsync(mail, &AsyncCompletion, &AsyncCompleted);
+    }
+
+    uint64_t const asyncEnd = CpuInstructions::Rdtsc();
+
+    while (AsyncCompleted < AsyncCount * Cores::GetCount())
+        CpuInstructions::DoNothing();
+
+    SYNC;
+
+    if (bsp)
+    {
+        DEBUG_TERM_
+            << "Async mail post cost: AVG "
+            << ((asyncEnd - asyncStart) / (AsyncCount * Cores::GetCount())) << EndLine;
+
         Scheduling = true;
     }
 }
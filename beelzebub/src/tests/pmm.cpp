@@ -41,6 +41,7 @@
 
 #include "tests/pmm.hpp"
 #include "memory/pmm.hpp"
+#include "memory/vmm.hpp"
 #include "cores.hpp"
 #include "kernel.hpp"
 #include <new>
@@ -64,6 +65,7 @@ static SmpLock DeleteLock {};
 
 static constexpr size_t const RandomIterations = 1'000'000;
 static constexpr size_t const CacheSize = 2048;
+static constexpr size_t const BatchSize = 200;
 static Atomic<paddr_inner_t> Cache[CacheSize];
 static constexpr size_t const SyncerCount = 10;
 static Atomic<paddr_inner_t> Syncers[SyncerCount];
@@ -165,6 +167,193 @@ void TestPmm(bool const bsp)
 
     SYNC;
 
+#ifdef PRINT
+    if (bsp) MSG_("Magazine reuse.%n");
+#endif
+
+    {
+        paddr_inner_t const first = getPtr();
+
+        delPtr(first);
+
+        paddr_inner_t const second = getPtr();
+
+        ASSERTX(first == second
+            , "A frame freed on this core should be the next one it allocates.")
+            (first)(second)XEND;
+        //  The per-core magazine is a stack.
+
+        delPtr(second);
+    }
+
+#ifdef PRINT
+    if (bsp) MSG_("Batch allocation.%n");
+#endif
+
+    {
+        paddr_t batch[BatchSize];
+
+        size_t const got = Pmm::AllocateFrames(BatchSize, FrameSize::_4KiB, batch);
+
+        ASSERTX(got == BatchSize)(got)XEND;
+
+        for (size_t i = 0; i < got; ++i)
+            for (size_t j = i + 1; j < got; ++j)
+                ASSERT(batch[i] != batch[j]);
+
+        Handle res = Pmm::FreeFrames(batch, got);
+
+        ASSERTX(res == HandleResult::Okay)(res)XEND;
+    }
+
+    SYNC;
+
+#ifdef PRINT
+    if (bsp) MSG_("Huge frame.%n");
+#endif
+
+    if (bsp)
+    {
+        paddr_t const huge = Pmm::AllocateFrame(FrameSize::_1GiB);
+
+        if (huge != nullpaddr)
+        {
+            //  Machines with little memory may simply have no free 1-GiB frame.
+
+            ASSERTX((huge.Value & (HugePageSize.Value - 1)) == 0)(huge)XEND;
+
+            Handle res = Pmm::FreeFrame(huge);
+
+            ASSERTX(res == HandleResult::Okay)(res)XEND;
+        }
+    }
+
+    SYNC;
+
+#ifdef PRINT
+    if (bsp) MSG_("Node preference.%n");
+#endif
+
+    {
+        NumaNode const localNode = Pmm::GetLocalNode();
+        paddr_t const local = Pmm::AllocateFrame(localNode);
+
+        ASSERT(local != nullpaddr);
+
+        NumaNode const frameNode = Pmm::GetFrameNode(local);
+        uint32_t const frameDist = Pmm::GetNodeDistance(localNode, frameNode);
+        bool localHasMemory = false;
+
+        for (size_t i = 0; i < Cores::GetCount(); ++i)
+        {
+            //  Every node that owns a core is asked for a frame; none may be
+            //  nearer to this core than the one the local allocation came from.
+
+            NumaNode const otherNode = Cores::Get(i)->Node;
+            paddr_t const other = Pmm::AllocateFrame(otherNode);
+
+            ASSERT(other != nullpaddr && other != local)(other)(local);
+
+            NumaNode const otherFrameNode = Pmm::GetFrameNode(other);
+
+            ASSERTX(frameDist <= Pmm::GetNodeDistance(localNode, otherFrameNode))
+                ((uint32_t)localNode)((uint32_t)frameNode)((uint32_t)otherFrameNode)XEND;
+
+            localHasMemory |= otherFrameNode == localNode;
+
+            Handle res = Pmm::FreeFrame(other);
+
+            ASSERTX(res == HandleResult::Okay)(res)XEND;
+        }
+
+        if (localHasMemory)
+            ASSERTX(frameNode == localNode)((uint32_t)localNode)((uint32_t)frameNode)XEND;
+
+        Handle res = Pmm::FreeFrame(local);
+
+        ASSERTX(res == HandleResult::Okay)(res)XEND;
+    }
+
+    SYNC;
+
+#ifdef PRINT
+    if (bsp) MSG_("Contiguous blocks.%n");
+#endif
+
+    {
+        psize_t const smallSize { 48 * 1024 }, largeSize { 6 * 1024 * 1024 };
+        psize_t const largeAlignment { 4 * 1024 * 1024 };
+
+        paddr_t const small = Pmm::AllocateContiguous(smallSize);
+        paddr_t const large = Pmm::AllocateContiguous(largeSize, largeAlignment);
+
+        ASSERT(small != nullpaddr && large != nullpaddr)(small)(large);
+
+        ASSERTX((small.Value & (64 * 1024 - 1)) == 0
+            , "Small blocks should be aligned to their size rounded up to a power of two.")
+            (small)XEND;
+        ASSERTX((large.Value & (largeAlignment.Value - 1)) == 0)(large)XEND;
+
+        for (psize_t offset { 0 }; offset < largeSize; offset += LargePageSize)
+        {
+            FrameSize size;
+            uint32_t refCnt;
+
+            Handle res = Pmm::GetFrameInfo(large + offset, size, refCnt);
+
+            ASSERTX(res == HandleResult::PageInUse && size == FrameSize::_2MiB)(res)(offset)XEND;
+            //  Frames in use report as such.
+        }
+
+        Handle res = Pmm::FreeContiguous(small, smallSize);
+
+        ASSERTX(res == HandleResult::Okay)(res)XEND;
+
+        res = Pmm::FreeContiguous(large, largeSize);
+
+        ASSERTX(res == HandleResult::Okay)(res)XEND;
+    }
+
+    SYNC;
+
+#ifdef PRINT
+    if (bsp) MSG_("Zeroed frame.%n");
+#endif
+
+    if (bsp)
+    {
+        Pmm::ReplenishZeroedFrames();
+
+        paddr_t const zeroed = Pmm::AllocateFrame(FrameAllocationOptions::Zeroed);
+
+        ASSERT(zeroed != nullpaddr);
+
+        vaddr_t vaddr = nullvaddr;
+
+        Handle res = Vmm::AllocatePages(nullptr, PageSize
+            , MemoryAllocationOptions::Reserve | MemoryAllocationOptions::VirtualKernelHeap
+            , MemoryFlags::Global | MemoryFlags::Writable
+            , MemoryContent::Generic
+            , vaddr);
+
+        ASSERTX(res == HandleResult::Okay)(res)XEND;
+
+        res = Vmm::MapPage(nullptr, vaddr, zeroed, MemoryFlags::Global | MemoryFlags::Writable);
+
+        ASSERTX(res == HandleResult::Okay)(res)XEND;
+
+        uint64_t const * const words = reinterpret_cast<uint64_t const *>(vaddr.Value);
+
+        for (size_t i = 0; i < PageSize.Value / sizeof(uint64_t); ++i)
+            ASSERTX(words[i] == 0)(i)(words[i])XEND;
+
+        res = Vmm::FreePages(nullptr, vaddr, PageSize);
+
+        ASSERTX(res == HandleResult::Okay)(res)XEND;
+    }
+
+    SYNC;
+
 #ifdef PRINT
     if (bsp) MSG_("Individual stability 1.%n");
 
@@ -41,9 +41,12 @@
 
 #include "tests/timer.hpp"
 #include "timer.hpp"
+#include "clock.hpp"
 #include <beel/sync/atomic.hpp>
 #include "system/timers/apic.timer.hpp"
 #include "system/rtc.hpp"
+#include "system/cpu.hpp"
+#include "cores.hpp"
 
 #include <debug.hpp>
 
@@ -51,7 +54,15 @@ using namespace Beelzebub;
 using namespace Beelzebub::System;
 using namespace Beelzebub::Terminals;
 
+static constexpr int const ExtraTimers = 100;
+//  Well over the old limit of 32 pending timers per core.
+static constexpr int const CancelledTimers = 20;
+
 static Synchronization::Atomic<int> Counter {6};
+static Synchronization::Atomic<int> ExtraCounter {ExtraTimers};
+static Synchronization::Atomic<int> CancelledCounter {0};
+static Synchronization::Atomic<int> RemoteCounter {0};
+static Synchronization::Atomic<uint32_t> RemoteCore {~0U};
 
 static __startup void Test1(void * cookie)
 {
@@ -64,6 +75,54 @@ static __startup void Test1(void * cookie)
     --Counter;
 }
 
+static __startup void Test2(void * cookie)
+{
+    (void)cookie;
+
+    --ExtraCounter;
+}
+
+static __startup void Test3(void * cookie)
+{
+    (void)cookie;
+
+    ++CancelledCounter;
+}
+
+static __startup void Test4(void * cookie)
+{
+    (void)cookie;
+
+    RemoteCore.Store(Cpu::GetData()->Index);
+    ++RemoteCounter;
+}
+
+#ifdef __BEELZEBUB_SETTINGS_SMP
+static void TestRemoteTimers()
+{
+    uint32_t const target = (Cpu::GetData()->Index + 1) % (uint32_t)Cores::GetCount();
+
+    TimerHandle fired, cancelled;
+
+    ASSERT(Timer::EnqueueOn(target, TimeSpanLite(1000), &Test4, nullptr, &fired));
+    ASSERT(fired.IsValid() && fired.Core == target)(fired.Core)(target);
+
+    ASSERT(Timer::EnqueueOn(target, 10secs_l, &Test3, nullptr, &cancelled));
+    ASSERT(cancelled.IsValid() && cancelled.Core == target)(cancelled.Core)(target);
+
+    ASSERT(Timer::Cancel(cancelled));
+    ASSERT(!Timer::Cancel(cancelled));
+    //  Both go through the target's mailbox, unless this thread moved there.
+
+    while (RemoteCounter == 0)
+        CpuInstructions::DoNothing();
+
+    ASSERT_EQ("%u4", target, RemoteCore.Load());
+    ASSERT(!Timer::Cancel(fired));
+    //  The handle went stale when the timer fired on the other core.
+}
+#endif
+
 void TestTimer()
 {
     InterruptGuard<true> intGuard;
@@ -82,6 +141,8 @@ void TestTimer()
                 << "; Ticks per microsecond: " << Timers::ApicTimer::TicksPerMicrosecond
                 << EndLine;
 
+    TimeInstantLite const start = Clock::Now();
+
     ASSERT(Timer::Enqueue(3secs_l        , &Test1, reinterpret_cast<void *>(3)));
     ASSERT(Timer::Enqueue(5secs_l        , &Test1, reinterpret_cast<void *>(5)));
     ASSERT(Timer::Enqueue(2secs_l        , &Test1, reinterpret_cast<void *>(2)));
@@ -89,9 +150,44 @@ void TestTimer()
     ASSERT(Timer::Enqueue(4secs_l        , &Test1, reinterpret_cast<void *>(4)));
     ASSERT(Timer::Enqueue(1secs_l        , &Test1, reinterpret_cast<void *>(1)));
 
+    for (int i = 0; i < ExtraTimers; ++i)
+        ASSERT(Timer::Enqueue(TimeSpanLite((uint64_t)(i * 7919 % 4000) * 1000 + 1), &Test2, reinterpret_cast<void *>(i)
+            , nullptr, TimeSpanLite((i & 1) ? 1000 : 0)));
+    //  Half of them may be coalesced with their neighbours.
+
+    TimerHandle handles[CancelledTimers];
+
+    for (int i = 0; i < CancelledTimers; ++i)
+        ASSERT(Timer::Enqueue(TimeSpanLite((uint64_t)(i + 1) * 100000), &Test3, reinterpret_cast<void *>(i), handles + i));
+
+    for (int i = 0; i < CancelledTimers; ++i)
+    {
+        ASSERT(Timer::Cancel(handles[i]))(i);
+        ASSERT(!Timer::Cancel(handles[i]))(i);
+    }
+
     ASSERT(InterruptState::IsEnabled());
 
-    while (Counter > 0) { }
+#ifdef __BEELZEBUB_SETTINGS_SMP
+    if (Cores::GetCount() > 1)
+        TestRemoteTimers();
+#endif
+
+    TimeInstantLite last = start;
+
+    while (Counter > 0)
+    {
+        TimeInstantLite now = Clock::Now();
+
+        ASSERT(now >= last)(now.Value)(last.Value);
+        last = now;
+    }
+
+    ASSERT(last.Value - start.Value >= (4secs_l).Value)(start.Value)(last.Value);
+    //  Timer deadlines are rounded to whole TSC counts per microsecond.
+
+    ASSERT_EQ("%i4", 0, ExtraCounter.Load());
+    ASSERT_EQ("%i4", 0, CancelledCounter.Load());
 }
 
 #endif
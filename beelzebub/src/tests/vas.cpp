@@ -43,6 +43,7 @@
 #include <memory/vmm.hpp>
 #include <execution/thread.hpp>
 #include <execution/thread_init.hpp>
+#include <scheduler.hpp>
 #include <beel/exceptions.hpp>
 
 #include <kernel.hpp>
@@ -131,8 +132,11 @@ void TestVas()
 
     testProcess.SetActive();
 
-    withInterrupts (false)
-        BootstrapThread.IntroduceNext(&testThread);
+    res = Scheduler::Enqueue(&testThread);
+
+    ASSERT(res.IsOkayResult()
+        , "Failed to schedule VAS test thread: %H."
+        , res);
 
     while (Barrier) CpuInstructions::DoNothing();
 }
@@ -209,6 +213,15 @@ void * TestThreadCode(void *)
     && (vaddr + 6 * PageSize < vaddr2 || vaddr +     PageSize >= vaddr2))
         TestDereferenceFailure(vaddr + 5 * PageSize);
 
+    vsize_t largest { 0 };
+
+    for (MemoryRegion const * reg = testProcess.Vas.First; reg != nullptr; reg = reg->Next)
+        if (reg->Content == MemoryContent::Free && reg->GetSize() > largest)
+            largest = reg->GetSize();
+
+    ASSERT_EQ("%Xp", largest, testProcess.Vas.Tree.Root->Payload.LargestFree);
+    //  The root summarizes the largest free region of the whole space.
+
     Barrier = false;
 
     while (true) CpuInstructions::Halt();
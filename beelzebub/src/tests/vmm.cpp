@@ -86,6 +86,18 @@ static __solid void TestVmmCrossIntegrity(bool const bsp);
 #endif
 
 static __solid void TestVmmIntegrity(bool const bsp);
+
+static Execution::Process CowParent, CowChild;
+
+static void SwitchProcess(Execution::Process * const other)
+{
+    Handle res = Cpu::GetProcess()->SwitchTo(other);
+
+    ASSERTX(res == HandleResult::Okay)(res)XEND;
+
+    Cpu::SetProcess(other);
+}
+
 // static __hot void DumpStack(INTERRUPT_HANDLER_ARGS, void * address, System::BreakpointProperties & bp);
 
 void TestVmm(bool const bsp)
@@ -442,6 +454,281 @@ void TestVmm(bool const bsp)
 
     SYNC;
 
+    if (bsp)
+    {
+#ifdef PRINT
+        MSG_("Transparent large pages.%n");
+#endif
+
+        vsize_t const size { 3 * LargePageSize.Value };
+        vaddr_t vaddr = nullvaddr;
+
+        Handle res = Vmm::AllocatePages(nullptr, size
+            , MemoryAllocationOptions::AllocateOnDemand | MemoryAllocationOptions::VirtualKernelHeap
+            , MemoryFlags::Global | MemoryFlags::Writable
+            , MemoryContent::Generic
+            , vaddr);
+
+        ASSERTX(res == HandleResult::Okay)(res)XEND;
+
+        vaddr_t const span = RoundUp(vaddr, LargePageSize);
+        uint64_t volatile * const words = reinterpret_cast<uint64_t volatile *>(span.Value);
+
+        words[PageSize.Value / sizeof(uint64_t)] = 42;
+
+        size_t count = 0;
+        res = Vmm::CountSmallPages(nullptr, span, count);
+
+        ASSERTX(res == HandleResult::PageMapped)(res)XEND;
+        //  The whole span ought to be a large page now.
+
+        res = Vmm::FreePages(nullptr, span, PageSize);
+
+        ASSERTX(res == HandleResult::Okay)(res)XEND;
+
+        res = Vmm::CountSmallPages(nullptr, span, count);
+
+        ASSERTX(res == HandleResult::Okay && count == 511)(res)(count)XEND;
+        ASSERTX(words[PageSize.Value / sizeof(uint64_t)] == 42)(words[PageSize.Value / sizeof(uint64_t)])XEND;
+        //  Freeing one page splits the large one, keeping the rest intact.
+
+        if (span > vaddr)
+        {
+            res = Vmm::FreePages(nullptr, vaddr, span - vaddr);
+
+            ASSERTX(res == HandleResult::Okay)(res)XEND;
+        }
+
+        res = Vmm::FreePages(nullptr, span + PageSize, vaddr + size - (span + PageSize));
+
+        ASSERTX(res == HandleResult::Okay)(res)XEND;
+    }
+
+    SYNC;
+
+    if (bsp)
+    {
+#ifdef PRINT
+        MSG_("Gathered unmapping.%n");
+#endif
+
+        vsize_t const size { 4096 * PageSize.Value };
+        vaddr_t vaddr = nullvaddr;
+
+        Handle res = Vmm::AllocatePages(nullptr, size
+            , MemoryAllocationOptions::Commit | MemoryAllocationOptions::VirtualKernelHeap
+            , MemoryFlags::Global | MemoryFlags::Writable
+            , MemoryContent::Generic
+            , vaddr);
+
+        ASSERTX(res == HandleResult::Okay)(res)XEND;
+
+        res = Vmm::FreePages(nullptr, vaddr, size);
+
+        ASSERTX(res == HandleResult::Okay)(res)XEND;
+        //  Spans more than one gather, each flushing the TLB whole.
+
+        for (vsize_t offset { 0 }; offset < size; offset += vsize_t(511 * PageSize.Value))
+        {
+            paddr_t paddr = nullpaddr;
+            res = Vmm::Translate(nullptr, vaddr + offset, paddr);
+
+            ASSERTX(res == HandleResult::PageUnmapped)(res)(vaddr + offset)XEND;
+        }
+    }
+
+    SYNC;
+
+    if (bsp)
+    {
+#ifdef PRINT
+        MSG_("Range flags.%n");
+#endif
+
+        vsize_t const size { 600 * PageSize.Value };
+        vaddr_t vaddr = nullvaddr;
+
+        Handle res = Vmm::AllocatePages(nullptr, size
+            , MemoryAllocationOptions::Commit | MemoryAllocationOptions::VirtualKernelHeap
+            , MemoryFlags::Global | MemoryFlags::Writable
+            , MemoryContent::Generic
+            , vaddr);
+
+        ASSERTX(res == HandleResult::Okay)(res)XEND;
+
+        res = Vmm::SetRangeFlags(nullptr, vaddr, size, MemoryFlags::Global);
+
+        ASSERTX(res == HandleResult::Okay)(res)XEND;
+        //  Crosses a table boundary, and flushes the TLB whole.
+
+        for (vsize_t offset { 0 }; offset < size; offset += vsize_t(299 * PageSize.Value))
+        {
+            MemoryFlags flags;
+            res = Vmm::GetPageFlags(nullptr, vaddr + offset, flags);
+
+            ASSERTX(res == HandleResult::Okay)(res)(vaddr + offset)XEND;
+            ASSERTX(0 == (flags & MemoryFlags::Writable))(vaddr + offset)XEND;
+        }
+
+        res = Vmm::SetRangeFlags(nullptr, vaddr, size, MemoryFlags::Global | MemoryFlags::Writable);
+
+        ASSERTX(res == HandleResult::Okay)(res)XEND;
+
+        res = Vmm::FreePages(nullptr, vaddr, size);
+
+        ASSERTX(res == HandleResult::Okay)(res)XEND;
+    }
+
+    SYNC;
+
+    if (bsp)
+    {
+#ifdef PRINT
+        MSG_("Copy-on-write cloning.%n");
+#endif
+
+        InterruptGuard<> intGuard;
+        //  The test processes are only active within this scope.
+
+        new (&CowParent) Execution::Process();
+        new (&CowChild) Execution::Process();
+
+        Handle res = Vmm::Initialize(&CowParent);
+
+        ASSERTX(res == HandleResult::Okay)(res)XEND;
+
+        res = Vmm::Initialize(&CowChild);
+
+        ASSERTX(res == HandleResult::Okay)(res)XEND;
+
+        Execution::Process * const home = Cpu::GetProcess();
+
+        SwitchProcess(&CowParent);
+
+        vaddr_t vaddr = nullvaddr;
+
+        res = Vmm::AllocatePages(nullptr, PageSize
+            , MemoryAllocationOptions::Commit | MemoryAllocationOptions::VirtualUser
+            , MemoryFlags::Userland | MemoryFlags::Writable
+            , MemoryContent::Generic
+            , vaddr);
+
+        ASSERTX(res == HandleResult::Okay)(res)XEND;
+
+        uint64_t volatile * const ptr = (uint64_t volatile *)(vaddr.Pointer);
+
+        *ptr = 0x1234;
+
+        res = Vmm::CloneAddressSpace(&CowParent, &CowChild);
+
+        ASSERTX(res == HandleResult::Okay)(res)XEND;
+
+        paddr_t shared = nullpaddr, paddr = nullpaddr;
+        FrameSize size;
+        uint32_t refCnt;
+
+        ASSERTX(Vmm::Translate(&CowParent, vaddr, shared) == HandleResult::Okay)XEND;
+        ASSERTX(Vmm::Translate(&CowChild, vaddr, paddr) == HandleResult::Okay)XEND;
+        ASSERTX(paddr == shared)(paddr)(shared)XEND;
+
+        res = Pmm::GetFrameInfo(shared, size, refCnt);
+
+        ASSERTX(res == HandleResult::PageInUse && refCnt == 2)(res)(refCnt)XEND;
+
+        *ptr = 0x5678;
+        //  The parent gets a copy of the shared frame.
+
+        ASSERTX(Vmm::Translate(&CowParent, vaddr, paddr) == HandleResult::Okay)XEND;
+        ASSERTX(paddr != shared)(paddr)(shared)XEND;
+
+        res = Pmm::GetFrameInfo(shared, size, refCnt);
+
+        ASSERTX(res == HandleResult::PageInUse && refCnt == 1)(res)(refCnt)XEND;
+
+        SwitchProcess(&CowChild);
+
+        ASSERTX(*ptr == 0x1234)(*ptr)XEND;
+
+        *ptr = 0x9ABC;
+        //  The child holds the last reference, so it writes to the frame in place.
+
+        ASSERTX(Vmm::Translate(&CowChild, vaddr, paddr) == HandleResult::Okay)XEND;
+        ASSERTX(paddr == shared)(paddr)(shared)XEND;
+
+        res = Pmm::GetFrameInfo(shared, size, refCnt);
+
+        ASSERTX(res == HandleResult::PageInUse && refCnt == 1)(res)(refCnt)XEND;
+
+        res = Vmm::FreePages(nullptr, vaddr, PageSize);
+
+        ASSERTX(res == HandleResult::Okay)(res)XEND;
+
+        SwitchProcess(&CowParent);
+
+        ASSERTX(*ptr == 0x5678)(*ptr)XEND;
+
+        res = Vmm::FreePages(nullptr, vaddr, PageSize);
+
+        ASSERTX(res == HandleResult::Okay)(res)XEND;
+
+        SwitchProcess(home);
+    }
+
+    SYNC;
+
+    if (bsp)
+    {
+#ifdef PRINT
+        MSG_("Fault-around.%n");
+#endif
+
+        size_t const oldWindow = Vmm::FaultAroundPages;
+        Vmm::FaultAroundPages = 16;
+
+        vsize_t const windowSize { 16 * PageSize.Value };
+        vsize_t const size { 40 * PageSize.Value };
+        vaddr_t vaddr = nullvaddr;
+
+        Handle res = Vmm::AllocatePages(nullptr, size
+            , MemoryAllocationOptions::AllocateOnDemand | MemoryAllocationOptions::VirtualKernelHeap
+            | MemoryAllocationOptions::GuardLow | MemoryAllocationOptions::GuardHigh
+            , MemoryFlags::Global | MemoryFlags::Writable
+            , MemoryContent::Generic
+            , vaddr);
+
+        ASSERTX(res == HandleResult::Okay)(res)XEND;
+
+        vaddr_t const first = vaddr + PageSize, last = vaddr + size - PageSize - PageSize;
+        //  The outermost pages are guards, so these are the outermost usable ones.
+
+        *((uint64_t volatile *)(first.Pointer)) = 1;
+        *((uint64_t volatile *)(last.Pointer)) = 2;
+
+        vaddr_t const lowEnd = RoundDown(first, windowSize) + windowSize;
+        vaddr_t const highStart = RoundDown(last, windowSize);
+
+        for (vaddr_t page = vaddr; page < vaddr + size; page += PageSize)
+        {
+            bool const expected = page >= first && page <= last && (page < lowEnd || page >= highStart);
+            //  Each fault fills its own aligned window, but neither the guard
+            //  pages nor anything between the two windows.
+
+            paddr_t paddr = nullpaddr;
+            res = Vmm::Translate(nullptr, page, paddr);
+
+            ASSERTX(res == (expected ? HandleResult::Okay : HandleResult::PageUnmapped))
+                (res)(page)(vaddr)XEND;
+        }
+
+        Vmm::FaultAroundPages = oldWindow;
+
+        res = Vmm::FreePages(nullptr, vaddr, size);
+
+        ASSERTX(res == HandleResult::Okay)(res)XEND;
+    }
+
+    SYNC;
+
     if (bsp)
     {
         // DEBUG_TERM_ << &(Memory::Vmm::KVas);
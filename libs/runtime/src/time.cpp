@@ -0,0 +1,125 @@
+/*
+    Copyright (c) 2017 Alexandru-Mihai Maftei. All rights reserved.
+
+
+    Developed by: Alexandru-Mihai Maftei
+    aka Vercas
+    http://vercas.com | https://github.com/vercas/Beelzebub
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to
+    deal with the Software without restriction, including without limitation the
+    rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+    sell copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+      * Redistributions of source code must retain the above copyright notice,
+        this list of conditions and the following disclaimers.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimers in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the names of Alexandru-Mihai Maftei, Vercas, nor the names of
+        its contributors may be used to endorse or promote products derived from
+        this Software without specific prior written permission.
+
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+    WITH THE SOFTWARE.
+
+    ---
+
+    You may also find the text of this license in "LICENSE.md", along with a more
+    thorough explanation regarding other files.
+*/
+
+#include <time.h>
+#include <sched.h>
+#include <errno.h>
+#include <kernel_data.hpp>
+
+using namespace Beelzebub;
+using namespace Beelzebub::Execution;
+
+/*
+Both functions rely on the time page which the kernel maps below the runtime,
+so neither of them needs a system call.
+ */
+
+int clock_gettime(clockid_t clk, struct timespec * tp)
+{
+#if defined(__BEELZEBUB__ARCH_AMD64)
+    TimePage const * const page = STARTUP_DATA.Time;
+
+    if unlikely(page == nullptr || !page->TscClock)
+    {
+        errno = ENOSYS;
+
+        return -1;
+    }
+
+    if unlikely(clk != CLOCK_REALTIME && clk != CLOCK_MONOTONIC)
+    {
+        errno = EINVAL;
+
+        return -1;
+    }
+
+    uint64_t us;
+    uint32_t seq;
+
+    do
+    {
+        seq = page->ReadBegin();
+
+        uint32_t low, high;
+
+        asm volatile ( "rdtsc \n\t" : "=a"(low), "=d"(high) );
+
+        uint64_t const counts = ((uint64_t)high << 32 | low) - page->Offset;
+
+        us = (uint64_t)(((uint128_t)counts * page->Multiplier) >> page->Shift);
+
+        if (clk == CLOCK_REALTIME)
+            us += page->BootEpoch;
+    } while unlikely(page->ReadRetry(seq));
+
+    if likely(tp != nullptr)
+    {
+        tp->tv_sec = (time_t)(us / 1000000);
+        tp->tv_nsec = (long)(us % 1000000) * 1000;
+    }
+
+    return 0;
+#else
+    (void)clk;
+    (void)tp;
+
+    errno = ENOSYS;
+
+    return -1;
+#endif
+}
+
+int sched_getcpu(void)
+{
+    TimePage const * const page = STARTUP_DATA.Time;
+
+    if unlikely(page == nullptr || !page->TscCpuIndex)
+    {
+        errno = ENOSYS;
+
+        return -1;
+    }
+
+    uint32_t aux;
+
+    asm volatile ( "rdtscp \n\t" : "=c"(aux) : : "eax", "edx" );
+    //  The kernel stores the index of each core in its auxiliary TSC MSR.
+
+    return (int)aux;
+}
@@ -144,12 +144,15 @@ __NAMESPACE_BEGIN
 
     static constexpr PageSize_t const PageSize { 0x1000 };
     static constexpr PageSize_t const LargePageSize { 0x200000 };
+    static constexpr PageSize_t const HugePageSize { 0x40000000 };
 
 __NAMESPACE_END
 #elif !defined(__ASSEMBLER__)
 #define __PAGE_SIZE         ((size_t)0x1000)
 #define __LARGE_PAGE_SIZE   ((size_t)0x200000)
+#define __HUGE_PAGE_SIZE    ((size_t)0x40000000)
 #else
 #define __PAGE_SIZE         0x1000
 #define __LARGE_PAGE_SIZE   0x200000
+#define __HUGE_PAGE_SIZE    0x40000000
 #endif
@@ -44,13 +44,110 @@ http://www.1024cores.net/home/lock-free-algorithms/queues/intrusive-mpsc-node-ba
 
 #pragma once
 
-#include <beel/metaprogramming.h>
+#include <beel/sync/atomic.hpp>
 
-namespace Beelzebub::Synchronization
+namespace Beelzebub { namespace Synchronization
 {
+    /**
+     *  <summary>
+     *  Lock-free queue with any number of producers and a single consumer.
+     *  Nodes are of type <typeparamref name="T"/>, which must have a member
+     *  named <c>Next</c> of type <c>T *</c>.
+     *  </summary>
+     *  <remarks>
+     *  A node must not be pushed again before it is popped. The queue cannot be
+     *  moved or copied because it points to its own stub node.
+     *  </remarks>
+     */
     template<typename T>
     struct MpscQueueIntrusive
     {
+        /*  Constructor(s)  */
 
+        inline MpscQueueIntrusive() : Head(&this->Stub), Tail(&this->Stub), Stub()
+        {
+            this->Stub.Next = nullptr;
+        }
+
+        MpscQueueIntrusive(MpscQueueIntrusive const &) = delete;
+        MpscQueueIntrusive & operator =(MpscQueueIntrusive const &) = delete;
+
+        /*  Operations  */
+
+        /**
+         *  <summary>Adds a node to the queue. Safe to call from any core.</summary>
+         *  <remarks>Wait-free; it takes a single atomic exchange.</remarks>
+         */
+        inline void Push(T * const node)
+        {
+            __atomic_store_n(&node->Next, nullptr, __ATOMIC_RELAXED);
+
+            T * const prev = this->Head.Xchg(node, MemoryOrder::AcqRel);
+
+            __atomic_store_n(&prev->Next, node, __ATOMIC_RELEASE);
+            //  Until this store, the consumer cannot reach the new node.
+        }
+
+        /**
+         *  <summary>Removes the oldest node from the queue. Only for the consumer.</summary>
+         *  <remarks>
+         *  May return null while a producer is halfway through pushing. The
+         *  node becomes reachable as soon as its push completes.
+         *  </remarks>
+         */
+        inline T * Pop()
+        {
+            T * tail = this->Tail;
+            T * next = __atomic_load_n(&tail->Next, __ATOMIC_ACQUIRE);
+
+            if (tail == &this->Stub)
+            {
+                if (next == nullptr)
+                    return nullptr;
+
+                this->Tail = tail = next;
+                next = __atomic_load_n(&next->Next, __ATOMIC_ACQUIRE);
+            }
+
+            if likely(next != nullptr)
+            {
+                this->Tail = next;
+
+                return tail;
+            }
+
+            if (tail != this->Head.Load(MemoryOrder::Acquire))
+                return nullptr;
+            //  A push is in progress.
+
+            this->Push(&this->Stub);
+            //  The last node cannot be popped without leaving something behind.
+
+            next = __atomic_load_n(&tail->Next, __ATOMIC_ACQUIRE);
+
+            if likely(next != nullptr)
+            {
+                this->Tail = next;
+
+                return tail;
+            }
+
+            return nullptr;
+        }
+
+        /**
+         *  <summary>Checks whether the queue is empty. Only for the consumer.</summary>
+         */
+        inline bool IsEmpty() const
+        {
+            return this->Tail == &this->Stub
+                && __atomic_load_n(&this->Stub.Next, __ATOMIC_ACQUIRE) == nullptr;
+        }
+
+        /*  Fields  */
+
+        Atomic<T *> Head;   //  Where producers push.
+        T * Tail;           //  Where the consumer pops.
+        T Stub;
     };
-}
+}}
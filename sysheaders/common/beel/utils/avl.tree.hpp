@@ -67,6 +67,22 @@ namespace Beelzebub { namespace Utils
         LevelOrder
     };
 
+    template<typename TPayload> class AvlTreeNode;
+
+    /*  Payloads may summarize their subtrees by specializing this. The summary
+        is recomputed whenever the height is, so it stays correct across
+        insertions, removals and rotations. Payloads changed in place must be
+        refreshed through `AvlTree::Refresh`.
+    */
+    template<typename TPayload>
+    struct AvlTreeAugmentation
+    {
+        static inline void Update(AvlTreeNode<TPayload> * const node)
+        {
+            (void)node;
+        }
+    };
+
     template<typename TPayload>
     class AvlTreeNode
     {
@@ -95,6 +111,8 @@ namespace Beelzebub { namespace Utils
 
         int ComputeHeight()
         {
+            AvlTreeAugmentation<TPayload>::Update(this);
+
             return this->Height = Maximum(GetHeight(this->Left), GetHeight(this->Right)) + 1;
         }
 
@@ -213,8 +231,12 @@ namespace Beelzebub { namespace Utils
             Handle res = Create(node, cookie);
 
             if likely(res.IsOkayResult())
+            {
                 node->Payload = payload;
 
+                AvlTreeAugmentation<TPayload>::Update(node);
+            }
+
             return res;
         }
 
@@ -565,6 +587,29 @@ namespace Beelzebub { namespace Utils
             return res;
         }
 
+        template<typename TKey>
+        static bool Refresh(TKey const & key, Node * const node)
+        {
+            if unlikely(node == nullptr)
+                return false;
+            //  Not found.
+
+            comp_t const compRes = Compare(node->Payload, key);
+
+            bool res = true;
+
+            if (compRes > 0)
+                res = Refresh<TKey>(key, node->Left);
+            else if (compRes < 0)
+                res = Refresh<TKey>(key, node->Right);
+
+            if likely(res)
+                node->ComputeHeight();
+            //  Every node on the path is summarized again, bottom-up.
+
+            return res;
+        }
+
         template<typename TLambda>
         static bool IteratePreOrder(Node * const node, TLambda lambda)
         {
@@ -855,6 +900,12 @@ namespace Beelzebub { namespace Utils
             }
         }
 
+        template<typename TKey>
+        bool Refresh(TKey const key)
+        {
+            return Refresh<TKey>(key, this->Root);
+        }
+
         /*  Iteration  */
 
         template<typename TLambda>
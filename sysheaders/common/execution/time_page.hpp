@@ -0,0 +1,115 @@
+/*
+    Copyright (c) 2017 Alexandru-Mihai Maftei. All rights reserved.
+
+
+    Developed by: Alexandru-Mihai Maftei
+    aka Vercas
+    http://vercas.com | https://github.com/vercas/Beelzebub
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to
+    deal with the Software without restriction, including without limitation the
+    rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+    sell copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+      * Redistributions of source code must retain the above copyright notice,
+        this list of conditions and the following disclaimers.
+      * Redistributions in binary form must reproduce the above copyright
+        notice, this list of conditions and the following disclaimers in the
+        documentation and/or other materials provided with the distribution.
+      * Neither the names of Alexandru-Mihai Maftei, Vercas, nor the names of
+        its contributors may be used to endorse or promote products derived from
+        this Software without specific prior written permission.
+
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    CONTRIBUTORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+    FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+    WITH THE SOFTWARE.
+
+    ---
+
+    You may also find the text of this license in "LICENSE.md", along with a more
+    thorough explanation regarding other files.
+*/
+
+#pragma once
+
+#include <beel/metaprogramming.h>
+
+namespace Beelzebub { namespace Execution
+{
+    /**
+     *  <summary>
+     *  Timekeeping parameters published by the kernel in a read-only page that
+     *  is mapped into every process, right below the runtime library.
+     *  </summary>
+     */
+    struct TimePage
+    {
+        /*  Fields  */
+
+        uint32_t volatile Sequence; //  Odd while the kernel is writing.
+
+        bool TscClock;      //  Whether time can be computed from the TSC.
+        bool TscCpuIndex;   //  Whether RDTSCP yields the index of the CPU.
+        uint8_t Shift;
+
+        uint64_t Multiplier;
+        uint64_t Offset;
+        uint64_t BootEpoch;
+        //  Microseconds are ((TSC - Offset) * Multiplier) >> Shift, and the
+        //  boot epoch is the number of microseconds since the Unix epoch at 0.
+
+        /*  Operations  */
+
+        /**
+         *  <summary>Starts reading the page; returns the sequence to check against.</summary>
+         */
+        inline uint32_t ReadBegin() const
+        {
+            uint32_t seq;
+
+            do
+            {
+                seq = this->Sequence;
+            } while unlikely(seq & 1);
+
+            COMPILER_MEMORY_BARRIER();
+
+            return seq;
+        }
+
+        /**
+         *  <summary>Checks whether the page changed since the read began.</summary>
+         */
+        inline bool ReadRetry(uint32_t const seq) const
+        {
+            COMPILER_MEMORY_BARRIER();
+
+            return this->Sequence != seq;
+        }
+
+        inline void WriteBegin()
+        {
+            ++this->Sequence;
+
+            COMPILER_MEMORY_BARRIER();
+        }
+
+        inline void WriteEnd()
+        {
+            COMPILER_MEMORY_BARRIER();
+
+            ++this->Sequence;
+        }
+        //  Stores are not reordered with other stores, and loads are not
+        //  reordered with other loads, on x86.
+    };
+
+    static_assert(sizeof(TimePage) <= 4096, "The time page must fit in a single page.");
+}}
@@ -1,5 +1,5 @@
 /*
-    Copyright (c) 2015 Alexandru-Mihai Maftei. All rights reserved.
+    Copyright (c) 2017 Alexandru-Mihai Maftei. All rights reserved.
 
 
     Developed by: Alexandru-Mihai Maftei
@@ -37,37 +37,8 @@
     thorough explanation regarding other files.
 */
 
-#include <execution/thread.hpp>
+#pragma once
 
-using namespace Beelzebub;
-using namespace Beelzebub::Execution;
+#include <beel/metaprogramming.h>
 
-/******************
-    Thread class
-*******************/
-
-/*  Linkage  */
-
-Handle Thread::IntroduceNext(Thread * const other)
-{
-    Thread * oldNext = this->Next;
-
-    Thread * current = oldNext;
-
-    do
-    {
-        if (current == other)
-            return HandleResult::ThreadAlreadyLinked;
-
-        current = current->Next;
-    }
-    while (current != oldNext);
-
-    this->Next = other;
-    oldNext->Previous = other;
-
-    other->Previous = this;
-    other->Next = oldNext;
-
-    return HandleResult::Okay;
-}
+__shared int sched_getcpu(void);
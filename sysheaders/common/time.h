@@ -44,3 +44,15 @@
 typedef int64_t time_t;
 typedef int64_t clock_t;
 typedef int32_t suseconds_t;
+typedef int32_t clockid_t;
+
+#define CLOCK_REALTIME  0
+#define CLOCK_MONOTONIC 1
+
+struct timespec
+{
+    time_t tv_sec;
+    long   tv_nsec;
+};
+
+__shared int clock_gettime(clockid_t clk, struct timespec * tp);